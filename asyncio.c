@@ -0,0 +1,498 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <linux/fb.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// 커널 헤더가 오래된 툴체인(ARM 크로스 컴파일러 등)에는 io_uring 헤더가 없으므로 이때는 스레드 풀만 빌드한다.
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ASYNC_IO_HAS_IO_URING
+#include <linux/io_uring.h>
+#endif
+#endif
+
+#include "fbbmp.h"
+
+// 비동기 I/O 엔진의 공유 상태
+static int asyncIOEngine = ASYNC_IO_ENGINE_SYNC;    // 현재 사용중인 엔진
+static int inFlightRequestCount = 0;                // 제출했지만 아직 완료되지 않은 요청 수
+static pthread_mutex_t asyncIOMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t asyncIOCompleted = PTHREAD_COND_INITIALIZER;
+
+#ifdef ASYNC_IO_HAS_IO_URING
+// io_uring 관련 (링은 커널과 공유하는 메모리이다.)
+static int fdIOUring = -1;
+static unsigned int ioUringEntryCount = 0;
+static void *pSubmissionRing = NULL;
+static void *pCompletionRing = NULL;
+static size_t submissionRingSize = 0;
+static size_t completionRingSize = 0;
+static struct io_uring_sqe *pSubmissionEntryArray = NULL;
+static unsigned int *pSubmissionTail = NULL;
+static unsigned int *pSubmissionMask = NULL;
+static unsigned int *pSubmissionIndexArray = NULL;
+static unsigned int *pCompletionHead = NULL;
+static unsigned int *pCompletionTail = NULL;
+static unsigned int *pCompletionMask = NULL;
+static struct io_uring_cqe *pCompletionEntryArray = NULL;
+static pthread_t completionThread;
+#endif
+
+// 스레드 풀 관련
+static AsyncIORequest *pPendingRequestHead = NULL;  // 작업 스레드가 가져갈 요청 목록
+static AsyncIORequest *pPendingRequestTail = NULL;
+static pthread_cond_t asyncIOSubmitted = PTHREAD_COND_INITIALIZER;
+static pthread_t workerThreadArray[ASYNC_IO_WORKER_COUNT];
+static bool isAsyncIOClosing = false;
+
+// 요청 하나를 현재 스레드에서 끝까지 실행한다. 완료된 바이트 수 또는 -errno를 반환한다.
+static int executeAsyncIORequest(AsyncIORequest *pRequest)
+{
+    if (pRequest->operation == ASYNC_IO_READAHEAD)
+    {
+        return -posix_fadvise(pRequest->fd, pRequest->offset, pRequest->length, POSIX_FADV_WILLNEED);
+    }
+
+    int doneBytes = 0;
+    while (doneBytes < pRequest->length)
+    {
+        const ssize_t result = (pRequest->operation == ASYNC_IO_WRITE)
+            ? pwrite(pRequest->fd, (unsigned char *)pRequest->pBuffer + doneBytes, pRequest->length - doneBytes, pRequest->offset + doneBytes)
+            : pread(pRequest->fd, (unsigned char *)pRequest->pBuffer + doneBytes, pRequest->length - doneBytes, pRequest->offset + doneBytes);
+        if (result < 0)
+        {
+            return -errno;
+        }
+        if (result == 0)
+        {
+            break;
+        }
+        doneBytes += result;
+    }
+    return doneBytes;
+}
+
+// 요청을 완료 상태로 만들고 기다리는 스레드를 깨운다.
+// 완료 함수가 있는 요청은 완료 함수가 소유하므로(해제할 수 있으므로) 완료 함수 호출 후에는 접근하지 않는다.
+// 진행중인 요청 수는 완료 함수까지 끝난 뒤에 줄여서 drainAsyncIO가 정리까지 기다리게 한다.
+static void completeAsyncIORequest(
+    AsyncIORequest *pRequest,
+    const int result)
+{
+    void (*pCompletionCallback)(AsyncIORequest *) = pRequest->pCompletionCallback;
+
+    if (pCompletionCallback)
+    {
+        pRequest->result = result;
+        pRequest->isCompleted = true;
+        pCompletionCallback(pRequest);
+    }
+
+    pthread_mutex_lock(&asyncIOMutex);
+    if (!pCompletionCallback)
+    {
+        pRequest->result = result;
+        pRequest->isCompleted = true;
+    }
+    inFlightRequestCount--;
+    pthread_cond_broadcast(&asyncIOCompleted);
+    pthread_mutex_unlock(&asyncIOMutex);
+}
+
+#ifdef ASYNC_IO_HAS_IO_URING
+// io_uring 완료 스레드. 완료 큐에서 결과를 꺼내 요청을 완료시킨다. user_data가 0이면 종료 신호이다.
+static void *ioUringCompletionWorker(void *pArgument)
+{
+    (void)pArgument;
+
+    for (;;)
+    {
+        if (syscall(__NR_io_uring_enter, fdIOUring, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+        {
+            perror("Failed to wait io_uring completion.");
+            exit(1);
+        }
+
+        unsigned int head = *pCompletionHead;
+        const unsigned int tail = __atomic_load_n(pCompletionTail, __ATOMIC_ACQUIRE);
+        bool isStopRequested = false;
+
+        while (head != tail)
+        {
+            const struct io_uring_cqe *pCompletionEntry = &pCompletionEntryArray[head & *pCompletionMask];
+            AsyncIORequest *pRequest = (AsyncIORequest *)(unsigned long)pCompletionEntry->user_data;
+            int result = pCompletionEntry->res;
+
+            head++;
+            __atomic_store_n(pCompletionHead, head, __ATOMIC_RELEASE);
+
+            if (pRequest)
+            {
+                // 드물게 일부만 읽거나 쓴 경우 나머지는 이 스레드에서 마저 처리한다.
+                if (pRequest->operation != ASYNC_IO_READAHEAD && result > 0 && result < pRequest->length)
+                {
+                    AsyncIORequest remainderRequest = *pRequest;
+                    remainderRequest.pBuffer = (unsigned char *)pRequest->pBuffer + result;
+                    remainderRequest.offset += result;
+                    remainderRequest.length -= result;
+
+                    const int remainderResult = executeAsyncIORequest(&remainderRequest);
+                    result = (remainderResult < 0) ? remainderResult : result + remainderResult;
+                }
+                completeAsyncIORequest(pRequest, result);
+            }
+            else
+            {
+                isStopRequested = true;
+            }
+        }
+
+        if (isStopRequested)
+        {
+            return NULL;
+        }
+    }
+}
+
+// 제출 큐에 항목 하나를 넣고 커널에 알린다. asyncIOMutex를 잡은 상태에서 호출한다.
+static void submitIOUringEntry(AsyncIORequest *pRequest)
+{
+    const unsigned int tail = *pSubmissionTail;
+    const unsigned int index = tail & *pSubmissionMask;
+    struct io_uring_sqe *pSubmissionEntry = &pSubmissionEntryArray[index];
+
+    memset(pSubmissionEntry, 0, sizeof(struct io_uring_sqe));
+    pSubmissionEntry->user_data = (unsigned long)pRequest;
+
+    if (!pRequest)
+    {
+        pSubmissionEntry->opcode = IORING_OP_NOP;
+    }
+    else if (pRequest->operation == ASYNC_IO_READAHEAD)
+    {
+        pSubmissionEntry->opcode = IORING_OP_FADVISE;
+        pSubmissionEntry->fd = pRequest->fd;
+        pSubmissionEntry->off = pRequest->offset;
+        pSubmissionEntry->len = pRequest->length;
+        pSubmissionEntry->fadvise_advice = POSIX_FADV_WILLNEED;
+    }
+    else
+    {
+        pSubmissionEntry->opcode = (pRequest->operation == ASYNC_IO_WRITE) ? IORING_OP_WRITE : IORING_OP_READ;
+        pSubmissionEntry->fd = pRequest->fd;
+        pSubmissionEntry->off = pRequest->offset;
+        pSubmissionEntry->addr = (unsigned long)pRequest->pBuffer;
+        pSubmissionEntry->len = pRequest->length;
+    }
+
+    pSubmissionIndexArray[index] = index;
+    __atomic_store_n(pSubmissionTail, tail + 1, __ATOMIC_RELEASE);
+
+    // 제출 큐는 io_uring_enter 안에서 바로 소비되므로 한 번에 하나씩 넣어도 가득 차지 않는다.
+    while (syscall(__NR_io_uring_enter, fdIOUring, 1, 0, 0, NULL, 0) < 0)
+    {
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+        {
+            perror("Failed to submit io_uring request.");
+            exit(1);
+        }
+    }
+}
+
+// 사용하는 요청 종류(읽기, 쓰기, 미리 읽기)를 커널이 모두 지원하는지 확인한다.
+// 리눅스 5.1~5.5는 io_uring은 만들 수 있지만 이 요청들을 -EINVAL로 거절하고 지원 여부 조회(PROBE)도 없으므로 false가 된다.
+static bool isIOUringOperationSupported()
+{
+    const unsigned char requiredOperationArray[] = { IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FADVISE };
+    struct io_uring_probe *pProbe = (struct io_uring_probe *)calloc(1, sizeof(struct io_uring_probe) + ASYNC_IO_PROBE_OP_COUNT * sizeof(struct io_uring_probe_op));
+    if (!pProbe)
+    {
+        perror("Failed to allocate io_uring probe.");
+        exit(1);
+    }
+
+    bool isSupported = syscall(__NR_io_uring_register, fdIOUring, IORING_REGISTER_PROBE, pProbe, ASYNC_IO_PROBE_OP_COUNT) >= 0;
+    for (size_t operationIndex = 0; isSupported && operationIndex < sizeof(requiredOperationArray); operationIndex++)
+    {
+        const unsigned char operation = requiredOperationArray[operationIndex];
+        isSupported = operation < pProbe->ops_len && (pProbe->ops[operation].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    free(pProbe);
+    return isSupported;
+}
+
+// io_uring을 만들고 링을 메모리에 매핑한다. 커널이나 보안 정책이 허용하지 않거나 필요한 요청을 지원하지 않으면 false를 반환한다.
+static bool initIOUring()
+{
+    struct io_uring_params parameters;
+    memset(&parameters, 0, sizeof(parameters));
+
+    fdIOUring = syscall(__NR_io_uring_setup, ASYNC_IO_QUEUE_DEPTH, &parameters);
+    if (fdIOUring < 0)
+    {
+        return false;
+    }
+
+    if (!isIOUringOperationSupported())
+    {
+        close(fdIOUring);
+        fdIOUring = -1;
+        return false;
+    }
+
+    ioUringEntryCount = parameters.sq_entries;
+    submissionRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned int);
+    completionRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(struct io_uring_cqe);
+    if (parameters.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        submissionRingSize = completionRingSize = MAX(submissionRingSize, completionRingSize);
+    }
+
+    pSubmissionRing = mmap(0, submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fdIOUring, IORING_OFF_SQ_RING);
+    pCompletionRing = (parameters.features & IORING_FEAT_SINGLE_MMAP)
+        ? pSubmissionRing
+        : mmap(0, completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fdIOUring, IORING_OFF_CQ_RING);
+    pSubmissionEntryArray = (struct io_uring_sqe *)mmap(0, parameters.sq_entries * sizeof(struct io_uring_sqe),
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fdIOUring, IORING_OFF_SQES);
+
+    if (pSubmissionRing == MAP_FAILED || pCompletionRing == MAP_FAILED || pSubmissionEntryArray == (struct io_uring_sqe *)MAP_FAILED)
+    {
+        close(fdIOUring);
+        fdIOUring = -1;
+        return false;
+    }
+
+    pSubmissionTail = (unsigned int *)((unsigned char *)pSubmissionRing + parameters.sq_off.tail);
+    pSubmissionMask = (unsigned int *)((unsigned char *)pSubmissionRing + parameters.sq_off.ring_mask);
+    pSubmissionIndexArray = (unsigned int *)((unsigned char *)pSubmissionRing + parameters.sq_off.array);
+    pCompletionHead = (unsigned int *)((unsigned char *)pCompletionRing + parameters.cq_off.head);
+    pCompletionTail = (unsigned int *)((unsigned char *)pCompletionRing + parameters.cq_off.tail);
+    pCompletionMask = (unsigned int *)((unsigned char *)pCompletionRing + parameters.cq_off.ring_mask);
+    pCompletionEntryArray = (struct io_uring_cqe *)((unsigned char *)pCompletionRing + parameters.cq_off.cqes);
+
+    pthread_create(&completionThread, NULL, ioUringCompletionWorker, NULL);
+    return true;
+}
+
+// 완료 스레드를 멈추고 링을 해제한다.
+static void closeIOUring()
+{
+    // 완료 스레드를 깨워서 종료시키기 위해 빈 요청(NOP)을 보낸다.
+    pthread_mutex_lock(&asyncIOMutex);
+    submitIOUringEntry(NULL);
+    pthread_mutex_unlock(&asyncIOMutex);
+    pthread_join(completionThread, NULL);
+
+    munmap(pSubmissionEntryArray, ioUringEntryCount * sizeof(struct io_uring_sqe));
+    if (pCompletionRing != pSubmissionRing)
+    {
+        munmap(pCompletionRing, completionRingSize);
+    }
+    munmap(pSubmissionRing, submissionRingSize);
+    close(fdIOUring);
+    fdIOUring = -1;
+}
+#else
+// io_uring 헤더 없이 빌드하면 io_uring을 만들 수 없으므로 initAsyncIO가 항상 스레드 풀로 대신한다.
+static bool initIOUring()
+{
+    return false;
+}
+
+// io_uring 엔진이 선택되지 않으므로 호출되지 않는다.
+static void submitIOUringEntry(AsyncIORequest *pRequest)
+{
+    (void)pRequest;
+}
+
+// io_uring 엔진이 선택되지 않으므로 호출되지 않는다.
+static void closeIOUring()
+{
+}
+#endif
+
+// 스레드 풀의 작업 스레드. 요청 목록에서 하나씩 꺼내 실행한다.
+static void *asyncIOWorker(void *pArgument)
+{
+    (void)pArgument;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&asyncIOMutex);
+        while (!pPendingRequestHead && !isAsyncIOClosing)
+        {
+            pthread_cond_wait(&asyncIOSubmitted, &asyncIOMutex);
+        }
+        if (!pPendingRequestHead)
+        {
+            pthread_mutex_unlock(&asyncIOMutex);
+            return NULL;
+        }
+
+        AsyncIORequest *pRequest = pPendingRequestHead;
+        pPendingRequestHead = pRequest->pNext;
+        if (!pPendingRequestHead)
+        {
+            pPendingRequestTail = NULL;
+        }
+        pthread_mutex_unlock(&asyncIOMutex);
+
+        completeAsyncIORequest(pRequest, executeAsyncIORequest(pRequest));
+    }
+}
+
+// 비동기 I/O 엔진을 시작한다. io_uring을 사용할 수 없으면 스레드 풀로 대신한다.
+void initAsyncIO(const int preferredEngine)
+{
+    asyncIOEngine = ASYNC_IO_ENGINE_SYNC;
+    isAsyncIOClosing = false;
+
+    if (preferredEngine == ASYNC_IO_ENGINE_IO_URING && initIOUring())
+    {
+        asyncIOEngine = ASYNC_IO_ENGINE_IO_URING;
+    }
+    else if (preferredEngine != ASYNC_IO_ENGINE_SYNC)
+    {
+        for (int workerIndex = 0; workerIndex < ASYNC_IO_WORKER_COUNT; workerIndex++)
+        {
+            pthread_create(&workerThreadArray[workerIndex], NULL, asyncIOWorker, NULL);
+        }
+        asyncIOEngine = ASYNC_IO_ENGINE_THREAD_POOL;
+    }
+}
+
+// 비동기 I/O 엔진의 이름 (io_uring, thread pool, sync)
+const char *getAsyncIOEngineName()
+{
+    switch (asyncIOEngine)
+    {
+        case ASYNC_IO_ENGINE_IO_URING: return "io_uring";
+        case ASYNC_IO_ENGINE_THREAD_POOL: return "thread pool";
+    }
+    return "sync";
+}
+
+// 요청을 제출한다. 완료는 waitAsyncIO로 기다리거나 완료 함수로 전달받는다.
+// 엔진이 시작되지 않았다면 그 자리에서 실행하고 완료시킨다.
+void submitAsyncIO(AsyncIORequest *pRequest)
+{
+    pRequest->isCompleted = false;
+    pRequest->result = 0;
+    pRequest->pNext = NULL;
+
+    pthread_mutex_lock(&asyncIOMutex);
+
+    // 완료 큐가 넘치지 않도록 동시에 진행중인 요청 수를 제한한다.
+    while (inFlightRequestCount >= ASYNC_IO_QUEUE_DEPTH)
+    {
+        pthread_cond_wait(&asyncIOCompleted, &asyncIOMutex);
+    }
+    inFlightRequestCount++;
+
+    if (asyncIOEngine == ASYNC_IO_ENGINE_IO_URING)
+    {
+        submitIOUringEntry(pRequest);
+        pthread_mutex_unlock(&asyncIOMutex);
+    }
+    else if (asyncIOEngine == ASYNC_IO_ENGINE_THREAD_POOL)
+    {
+        if (pPendingRequestTail)
+        {
+            pPendingRequestTail->pNext = pRequest;
+        }
+        else
+        {
+            pPendingRequestHead = pRequest;
+        }
+        pPendingRequestTail = pRequest;
+        pthread_cond_signal(&asyncIOSubmitted);
+        pthread_mutex_unlock(&asyncIOMutex);
+    }
+    else
+    {
+        pthread_mutex_unlock(&asyncIOMutex);
+        completeAsyncIORequest(pRequest, executeAsyncIORequest(pRequest));
+    }
+}
+
+// 요청이 완료될 때까지 기다리고 결과(완료된 바이트 수 또는 -errno)를 반환한다.
+int waitAsyncIO(AsyncIORequest *pRequest)
+{
+    pthread_mutex_lock(&asyncIOMutex);
+    while (!pRequest->isCompleted)
+    {
+        pthread_cond_wait(&asyncIOCompleted, &asyncIOMutex);
+    }
+    pthread_mutex_unlock(&asyncIOMutex);
+
+    return pRequest->result;
+}
+
+// 제출한 모든 요청이 완료될 때까지 기다린다.
+void drainAsyncIO()
+{
+    pthread_mutex_lock(&asyncIOMutex);
+    while (inFlightRequestCount > 0)
+    {
+        pthread_cond_wait(&asyncIOCompleted, &asyncIOMutex);
+    }
+    pthread_mutex_unlock(&asyncIOMutex);
+}
+
+// 남은 요청을 모두 끝내고 비동기 I/O 엔진을 멈춘다.
+void closeAsyncIO()
+{
+    drainAsyncIO();
+
+    if (asyncIOEngine == ASYNC_IO_ENGINE_IO_URING)
+    {
+        closeIOUring();
+    }
+    else if (asyncIOEngine == ASYNC_IO_ENGINE_THREAD_POOL)
+    {
+        pthread_mutex_lock(&asyncIOMutex);
+        isAsyncIOClosing = true;
+        pthread_cond_broadcast(&asyncIOSubmitted);
+        pthread_mutex_unlock(&asyncIOMutex);
+
+        for (int workerIndex = 0; workerIndex < ASYNC_IO_WORKER_COUNT; workerIndex++)
+        {
+            pthread_join(workerThreadArray[workerIndex], NULL);
+        }
+    }
+
+    asyncIOEngine = ASYNC_IO_ENGINE_SYNC;
+}
+
+// 미리 읽기 요청이 끝나면 파일을 닫고 요청을 해제한다.
+static void completePrefetch(AsyncIORequest *pRequest)
+{
+    close(pRequest->fd);
+    free(pRequest);
+}
+
+// 곧 열게 될 파일을 페이지 캐시로 미리 읽도록 요청한다. 완료를 기다리지 않는다.
+void prefetchImageFile(const char *pFileName)
+{
+    const int fdPrefetch = open(pFileName, O_RDONLY);
+    if (fdPrefetch < 0)
+    {
+        return;
+    }
+
+    AsyncIORequest *pRequest = (AsyncIORequest *)calloc(1, sizeof(AsyncIORequest));
+    pRequest->operation = ASYNC_IO_READAHEAD;
+    pRequest->fd = fdPrefetch;
+    pRequest->length = 0;       // 0이면 파일 끝까지
+    pRequest->offset = 0;
+    pRequest->pCompletionCallback = completePrefetch;
+    submitAsyncIO(pRequest);
+}
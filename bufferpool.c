@@ -0,0 +1,283 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <linux/fb.h>
+#include <sys/mman.h>
+
+#include "fbbmp.h"
+
+// 블록 앞에 붙는 헤더. 버퍼는 헤더 바로 뒤(BUFFER_POOL_HEADER_SIZE)에서 시작한다.
+typedef struct bufferPoolBlock
+{
+    struct bufferPoolBlock *pNext;  // 놓아둔 블록 목록의 다음 블록 (최근에 돌려받은 블록부터)
+    size_t mappedSize;              // 헤더를 포함한 매핑 크기
+    bool isHugePage;                // 큰 페이지로 매핑했는지
+    bool isLocked;                  // mlock으로 고정했는지
+} BufferPoolBlock;
+
+// 버퍼 풀의 공유 상태. 디코딩 스레드와 비동기 I/O 완료 스레드도 버퍼를 돌려주므로 뮤텍스로 보호한다.
+static pthread_mutex_t bufferPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+static BufferPoolBlock *pCachedBlockList = NULL;
+static long long bufferPoolBudget = (long long)BUFFER_POOL_DEFAULT_MEMORY_MB << 20;
+static bool isBufferPoolHugePageEnabled = false;
+static bool isBufferPoolLockEnabled = false;
+static BufferPoolStatistics bufferPoolStatistics = {0};
+
+// 크기를 단위의 배수로 올린다.
+static size_t alignToGranule(
+    const size_t size,
+    const size_t granule)
+{
+    return (size + granule - 1) / granule * granule;
+}
+
+// 매핑한 블록 크기의 합 (사용 중 + 놓아둔 블록)
+static long long getMappedBytes()
+{
+    return bufferPoolStatistics.inUseBytes + bufferPoolStatistics.cachedBytes;
+}
+
+// 블록의 매핑을 해제하고 통계에서 뺀다.
+static void unmapPoolBlock(BufferPoolBlock *pBlock)
+{
+    if (pBlock->isHugePage)
+    {
+        bufferPoolStatistics.hugePageBytes -= pBlock->mappedSize;
+    }
+    if (pBlock->isLocked)
+    {
+        bufferPoolStatistics.lockedBytes -= pBlock->mappedSize;
+    }
+    bufferPoolStatistics.unmapCount++;
+    munmap(pBlock, pBlock->mappedSize);
+}
+
+// 놓아둔 블록 중 가장 오래 쓰지 않은(목록의 마지막) 블록을 해제한다. 놓아둔 블록이 없으면 false를 반환한다.
+static bool evictCachedPoolBlock()
+{
+    BufferPoolBlock **ppLink = &pCachedBlockList;
+    if (!*ppLink)
+    {
+        return false;
+    }
+    while ((*ppLink)->pNext)
+    {
+        ppLink = &(*ppLink)->pNext;
+    }
+
+    BufferPoolBlock *pBlock = *ppLink;
+    *ppLink = NULL;
+    bufferPoolStatistics.cachedBytes -= pBlock->mappedSize;
+    unmapPoolBlock(pBlock);
+    return true;
+}
+
+// 큰 페이지 경계에 맞춘 익명 메모리를 매핑하고 THP를 요청한다. 경계에 맞추지 않으면 커널이 큰 페이지를 쓸 수 없다.
+static void *mapTransparentHugePageRegion(const size_t size)
+{
+    const size_t reservedSize = size + BUFFER_POOL_HUGE_PAGE_SIZE;
+    unsigned char *pReserved = (unsigned char *)mmap(0, reservedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pReserved == (unsigned char *)MAP_FAILED)
+    {
+        return MAP_FAILED;
+    }
+
+    // 경계 앞뒤로 남는 부분은 돌려준다.
+    unsigned char *pAligned = (unsigned char *)alignToGranule((size_t)pReserved, BUFFER_POOL_HUGE_PAGE_SIZE);
+    if (pAligned > pReserved)
+    {
+        munmap(pReserved, pAligned - pReserved);
+    }
+    if (pReserved + reservedSize > pAligned + size)
+    {
+        munmap(pAligned + size, pReserved + reservedSize - (pAligned + size));
+    }
+
+    madvise(pAligned, size, MADV_HUGEPAGE);
+    return pAligned;
+}
+
+// 새 블록을 매핑한다. 페이지 폴트가 사용할 때마다 일어나지 않도록 매핑할 때 미리 채워둔다.
+static BufferPoolBlock *mapPoolBlock(const size_t mappedSize)
+{
+    BufferPoolBlock *pBlock = MAP_FAILED;
+    bool isHugePage = false;
+
+    if (isBufferPoolHugePageEnabled && mappedSize >= BUFFER_POOL_HUGE_PAGE_SIZE)
+    {
+        // 미리 예약된 큰 페이지(hugetlbfs)를 먼저 시도하고, 없으면 THP를 요청한다.
+        pBlock = (BufferPoolBlock *)mmap(0, mappedSize, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (pBlock == (BufferPoolBlock *)MAP_FAILED)
+        {
+            pBlock = (BufferPoolBlock *)mapTransparentHugePageRegion(mappedSize);
+#ifdef MADV_POPULATE_WRITE
+            if (pBlock != (BufferPoolBlock *)MAP_FAILED)
+            {
+                madvise(pBlock, mappedSize, MADV_POPULATE_WRITE);
+            }
+#endif
+        }
+        isHugePage = pBlock != (BufferPoolBlock *)MAP_FAILED;
+    }
+
+    if (pBlock == (BufferPoolBlock *)MAP_FAILED)
+    {
+        pBlock = (BufferPoolBlock *)mmap(0, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    }
+    if (pBlock == (BufferPoolBlock *)MAP_FAILED)
+    {
+        perror("Failed to map buffer pool block.");
+        exit(1);
+    }
+
+    pBlock->pNext = NULL;
+    pBlock->mappedSize = mappedSize;
+    pBlock->isHugePage = isHugePage;
+    pBlock->isLocked = false;
+
+    // 고정할 수 없으면(RLIMIT_MEMLOCK 등) 한 번만 알리고 이후로는 고정하지 않는다.
+    if (isBufferPoolLockEnabled)
+    {
+        if (mlock(pBlock, mappedSize) == 0)
+        {
+            pBlock->isLocked = true;
+            bufferPoolStatistics.lockedBytes += mappedSize;
+        }
+        else
+        {
+            printf("Buffer pool : cannot lock memory (%s), not locked\n", strerror(errno));
+            isBufferPoolLockEnabled = false;
+        }
+    }
+
+    if (isHugePage)
+    {
+        bufferPoolStatistics.hugePageBytes += mappedSize;
+    }
+    bufferPoolStatistics.mapCount++;
+    return pBlock;
+}
+
+// 버퍼 풀의 메모리 한도와 큰 페이지, mlock 사용 여부를 정한다. 버퍼를 요청하기 전에 호출한다.
+void initBufferPool(
+    const long long memoryBudget,
+    const bool isHugePageEnabled,
+    const bool isLockEnabled)
+{
+    pthread_mutex_lock(&bufferPoolMutex);
+    bufferPoolBudget = memoryBudget;
+    isBufferPoolHugePageEnabled = isHugePageEnabled;
+    isBufferPoolLockEnabled = isLockEnabled;
+    pthread_mutex_unlock(&bufferPoolMutex);
+}
+
+// 화면이나 이미지 크기의 버퍼를 빌린다. 놓아둔 블록 중 크기가 맞는 것이 있으면 다시 쓴다. 내용은 초기화하지 않는다.
+// 너무 큰 블록(요청의 두 배 이상)은 작은 요청에 쓰지 않는다. 한도를 넘으면 오래 쓰지 않은 블록부터 해제한다.
+void *allocatePoolBuffer(const size_t size)
+{
+    const size_t granule = (isBufferPoolHugePageEnabled && size >= BUFFER_POOL_HUGE_PAGE_SIZE / 2)
+        ? BUFFER_POOL_HUGE_PAGE_SIZE
+        : BUFFER_POOL_SIZE_GRANULE;
+    const size_t mappedSize = alignToGranule(BUFFER_POOL_HEADER_SIZE + size, granule);
+
+    pthread_mutex_lock(&bufferPoolMutex);
+    bufferPoolStatistics.requestCount++;
+
+    // 들어가는 블록 중 가장 작은 블록을 찾는다.
+    BufferPoolBlock **ppBestLink = NULL;
+    for (BufferPoolBlock **ppLink = &pCachedBlockList; *ppLink; ppLink = &(*ppLink)->pNext)
+    {
+        const size_t blockSize = (*ppLink)->mappedSize;
+        if (blockSize >= mappedSize && blockSize / 2 < mappedSize && (!ppBestLink || blockSize < (*ppBestLink)->mappedSize))
+        {
+            ppBestLink = ppLink;
+        }
+    }
+
+    BufferPoolBlock *pBlock = NULL;
+    if (ppBestLink)
+    {
+        pBlock = *ppBestLink;
+        *ppBestLink = pBlock->pNext;
+        bufferPoolStatistics.cachedBytes -= pBlock->mappedSize;
+        bufferPoolStatistics.reuseCount++;
+    }
+    else
+    {
+        while (getMappedBytes() + (long long)mappedSize > bufferPoolBudget && evictCachedPoolBlock())
+        {
+        }
+        if (getMappedBytes() + (long long)mappedSize > bufferPoolBudget)
+        {
+            bufferPoolStatistics.overBudgetCount++;
+        }
+        pBlock = mapPoolBlock(mappedSize);
+    }
+
+    pBlock->pNext = NULL;
+    bufferPoolStatistics.inUseBytes += pBlock->mappedSize;
+    bufferPoolStatistics.peakBytes = MAX(bufferPoolStatistics.peakBytes, getMappedBytes());
+    pthread_mutex_unlock(&bufferPoolMutex);
+
+    return (unsigned char *)pBlock + BUFFER_POOL_HEADER_SIZE;
+}
+
+// 빌린 버퍼를 돌려준다. 블록은 해제하지 않고 다음 요청을 위해 놓아둔다. NULL이면 아무것도 하지 않는다.
+void releasePoolBuffer(void *pBuffer)
+{
+    if (!pBuffer)
+    {
+        return;
+    }
+
+    BufferPoolBlock *pBlock = (BufferPoolBlock *)((unsigned char *)pBuffer - BUFFER_POOL_HEADER_SIZE);
+
+    pthread_mutex_lock(&bufferPoolMutex);
+    bufferPoolStatistics.inUseBytes -= pBlock->mappedSize;
+    bufferPoolStatistics.cachedBytes += pBlock->mappedSize;
+    pBlock->pNext = pCachedBlockList;
+    pCachedBlockList = pBlock;
+
+    // 사용 중인 블록이 한도를 넘겼던 경우 돌려받은 만큼 줄인다.
+    while (getMappedBytes() > bufferPoolBudget && evictCachedPoolBlock())
+    {
+    }
+    pthread_mutex_unlock(&bufferPoolMutex);
+}
+
+// 버퍼 풀 사용 통계를 복사한다.
+void getBufferPoolStatistics(BufferPoolStatistics *pStatistics)
+{
+    pthread_mutex_lock(&bufferPoolMutex);
+    *pStatistics = bufferPoolStatistics;
+    pthread_mutex_unlock(&bufferPoolMutex);
+}
+
+// 버퍼 풀 사용 통계를 출력한다.
+void printBufferPoolStatistics()
+{
+    BufferPoolStatistics statistics;
+    getBufferPoolStatistics(&statistics);
+
+    printf("Buffer pool : %lld requests, %lld reused, %lld mapped, %lld unmapped, %lld over budget\n",
+        statistics.requestCount, statistics.reuseCount, statistics.mapCount, statistics.unmapCount, statistics.overBudgetCount);
+    printf("Buffer pool : %.1f MB in use, %.1f MB cached, %.1f MB peak (budget %.1f MB), %.1f MB huge pages, %.1f MB locked\n",
+        (double)statistics.inUseBytes / (1 << 20), (double)statistics.cachedBytes / (1 << 20),
+        (double)statistics.peakBytes / (1 << 20), (double)bufferPoolBudget / (1 << 20),
+        (double)statistics.hugePageBytes / (1 << 20), (double)statistics.lockedBytes / (1 << 20));
+}
+
+// 놓아둔 블록을 모두 해제한다.
+void closeBufferPool()
+{
+    pthread_mutex_lock(&bufferPoolMutex);
+    while (evictCachedPoolBlock())
+    {
+    }
+    pthread_mutex_unlock(&bufferPoolMutex);
+}
@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <linux/fb.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "fbbmp.h"
+
+// 매핑한 메타데이터 목록. 디렉토리 하나만 탐색하므로 공유 상태로 둔다.
+static ImageCatalog *pImageCatalog = NULL;
+static int imageSortKey = IMAGE_SORT_NONE;  // qsort 비교 함수가 사용할 정렬 기준
+
+// 목록에서 파일명으로 항목을 찾는다. 없으면 NULL을 반환한다.
+static ImageCatalogEntry *findImageCatalogEntry(const char *pFileName)
+{
+    for (int entryIndex = 0; entryIndex < pImageCatalog->entryCount; entryIndex++)
+    {
+        if (!strcmp(pImageCatalog->entryArray[entryIndex].fileName, pFileName))
+        {
+            return &pImageCatalog->entryArray[entryIndex];
+        }
+    }
+    return NULL;
+}
+
+// 파일의 헤더와 전체 내용을 읽어 항목을 채운다. 파일이 바뀌었을 때만 호출한다.
+static void readImageCatalogEntry(
+    ImageCatalogEntry *pEntry,
+    const char *pFileName,
+    const struct stat *pFileStatus)
+{
+    memset(pEntry, 0, sizeof(ImageCatalogEntry));
+    strncpy(pEntry->fileName, pFileName, FILE_NAME_MAX_LENGTH);
+    pEntry->fileSize = pFileStatus->st_size;
+    pEntry->modifiedTime = getModifiedTime(pFileStatus);
+
+    const int fdImageInput = open(pFileName, O_RDONLY);
+    if (fdImageInput < 0)
+    {
+        return;
+    }
+
+    BMPHeader bitmapHeader;
+    if (read(fdImageInput, &bitmapHeader, BITMAP_HEADER_SIZE) == BITMAP_HEADER_SIZE)
+    {
+        pEntry->isValid = isSupportedBitmapHeader(&bitmapHeader, pEntry->fileSize);
+        pEntry->width = bitmapHeader.biWidth;
+        pEntry->height = bitmapHeader.biHeight;
+        pEntry->bitCount = bitmapHeader.biBitCount;
+    }
+
+    // 내용이 같은 파일(복사본)을 구분할 수 있도록 파일 전체의 체크섬을 저장한다.
+    if (pEntry->fileSize > 0)
+    {
+        const void *pFileData = mmap(0, pEntry->fileSize, PROT_READ, MAP_PRIVATE, fdImageInput, 0);
+        if (pFileData != MAP_FAILED)
+        {
+            madvise((void *)pFileData, pEntry->fileSize, MADV_SEQUENTIAL);
+            pEntry->contentHash = calculateChecksum(pFileData, pEntry->fileSize);
+            munmap((void *)pFileData, pEntry->fileSize);
+        }
+    }
+    close(fdImageInput);
+}
+
+// 이미지 디렉토리의 메타데이터 목록 파일을 매핑한다. 매핑한 메모리에 바로 쓰므로 따로 저장하지 않아도 파일에 반영된다.
+// 파일을 만들 수 없으면(읽기 전용 디렉토리 등) 저장하지 않고 메모리에서만 사용한다.
+void openImageCatalog(const char *pPath)
+{
+    char catalogPath[FILE_PATH_MAX_LENGTH];
+    snprintf(catalogPath, sizeof(catalogPath), "%s/%s", pPath, IMAGE_CATALOG_FILE_NAME);
+
+    const int fdCatalog = open(catalogPath, O_RDWR | O_CREAT, 0644);
+    if (fdCatalog >= 0 && ftruncate(fdCatalog, sizeof(ImageCatalog)) == 0)
+    {
+        pImageCatalog = (ImageCatalog *)mmap(0, sizeof(ImageCatalog), PROT_READ | PROT_WRITE, MAP_SHARED, fdCatalog, 0);
+    }
+    else
+    {
+        printf("Image catalog : cannot write %s, not saved\n", catalogPath);
+        pImageCatalog = (ImageCatalog *)mmap(0, sizeof(ImageCatalog), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (fdCatalog >= 0)
+    {
+        close(fdCatalog);
+    }
+
+    if (pImageCatalog == (ImageCatalog *)MAP_FAILED)
+    {
+        perror("Failed to map image catalog.");
+        exit(1);
+    }
+
+    // 처음 만들었거나 형식이 다른 파일이면 비운다.
+    if (pImageCatalog->magic != IMAGE_CATALOG_MAGIC
+        || pImageCatalog->version != IMAGE_CATALOG_VERSION
+        || pImageCatalog->entrySize != sizeof(ImageCatalogEntry)
+        || pImageCatalog->entryCount < 0
+        || pImageCatalog->entryCount > FILE_NAME_ARRAY_SIZE)
+    {
+        memset(pImageCatalog, 0, sizeof(ImageCatalog));
+        pImageCatalog->magic = IMAGE_CATALOG_MAGIC;
+        pImageCatalog->version = IMAGE_CATALOG_VERSION;
+        pImageCatalog->entrySize = sizeof(ImageCatalogEntry);
+    }
+}
+
+// 파일 목록에 맞춰 메타데이터 목록을 갱신한다. 크기나 수정 시각이 바뀐 파일만 다시 읽고, 없어진 파일은 지운다.
+void updateImageCatalog(unsigned char *pFileNameArray[FILE_NAME_ARRAY_SIZE])
+{
+    ImageCatalogEntry updatedEntryArray[FILE_NAME_ARRAY_SIZE];
+    int updatedEntryCount = 0;
+    int rereadEntryCount = 0;
+
+    for (int fileNameArrayIndex = 0; fileNameArrayIndex < FILE_NAME_ARRAY_SIZE; fileNameArrayIndex++)
+    {
+        const char *pFileName = (const char *)pFileNameArray[fileNameArrayIndex];
+        struct stat fileStatus;
+        if (!pFileName || stat(pFileName, &fileStatus) < 0)
+        {
+            continue;
+        }
+
+        const ImageCatalogEntry *pEntry = findImageCatalogEntry(pFileName);
+        if (pEntry && pEntry->fileSize == fileStatus.st_size && pEntry->modifiedTime == getModifiedTime(&fileStatus))
+        {
+            updatedEntryArray[updatedEntryCount++] = *pEntry;
+        }
+        else
+        {
+            readImageCatalogEntry(&updatedEntryArray[updatedEntryCount++], pFileName, &fileStatus);
+            rereadEntryCount++;
+        }
+    }
+
+    // 쓰는 도중에 종료되어도 덜 쓴 항목을 사용하지 않도록 항목 수를 마지막에 쓴다.
+    pImageCatalog->entryCount = 0;
+    memcpy(pImageCatalog->entryArray, updatedEntryArray, sizeof(ImageCatalogEntry) * updatedEntryCount);
+    pImageCatalog->entryCount = updatedEntryCount;
+
+    printf("Image catalog : %d files, %d updated\n", updatedEntryCount, rereadEntryCount);
+}
+
+// 파일의 메타데이터를 찾는다. 목록을 만든 뒤 파일이 바뀌었다면 다시 읽는다. 파일이 없으면 NULL을 반환한다.
+// 이미지 데이터는 읽지 않으므로 파일을 열기 전에 Text LCD에 정보를 바로 출력할 수 있다.
+const ImageCatalogEntry *getImageCatalogEntry(const char *pFileName)
+{
+    struct stat fileStatus;
+    if (stat(pFileName, &fileStatus) < 0)
+    {
+        return NULL;
+    }
+
+    ImageCatalogEntry *pEntry = findImageCatalogEntry(pFileName);
+    if (!pEntry)
+    {
+        if (pImageCatalog->entryCount >= FILE_NAME_ARRAY_SIZE)
+        {
+            return NULL;
+        }
+        pEntry = &pImageCatalog->entryArray[pImageCatalog->entryCount++];
+        pEntry->fileSize = -1;
+    }
+
+    if (pEntry->fileSize != fileStatus.st_size || pEntry->modifiedTime != getModifiedTime(&fileStatus))
+    {
+        readImageCatalogEntry(pEntry, pFileName, &fileStatus);
+    }
+    return pEntry;
+}
+
+// 정렬 기준에 따라 두 파일을 비교한다. 기준 값이 같으면 파일명 순서로 정한다.
+static int compareCatalogImageFiles(
+    const void *pFileNameA,
+    const void *pFileNameB)
+{
+    const char *pNameA = *(const char **)pFileNameA;
+    const char *pNameB = *(const char **)pFileNameB;
+    const ImageCatalogEntry *pEntryA = findImageCatalogEntry(pNameA);
+    const ImageCatalogEntry *pEntryB = findImageCatalogEntry(pNameB);
+
+    long long valueA = 0;
+    long long valueB = 0;
+    if (imageSortKey == IMAGE_SORT_RESOLUTION)
+    {
+        valueA = (long long)pEntryA->width * pEntryA->height;
+        valueB = (long long)pEntryB->width * pEntryB->height;
+    }
+    else if (imageSortKey == IMAGE_SORT_DATE)
+    {
+        valueA = pEntryA->modifiedTime;
+        valueB = pEntryB->modifiedTime;
+    }
+
+    if (valueA != valueB)
+    {
+        return (valueA < valueB) ? -1 : 1;
+    }
+    return strcmp(pNameA, pNameB);
+}
+
+// 읽을 수 없는 파일과 조건(최소 해상도, 수정 시각)에 맞지 않는 파일을 목록에서 빼고 정렬한다.
+// 뺀 파일명은 해제하고 남은 파일명을 배열 앞쪽으로 모은다. 파일은 열지 않고 메타데이터만 사용한다.
+void selectCatalogImageFiles(
+    unsigned char *pFileNameArray[FILE_NAME_ARRAY_SIZE],
+    const int sortKey,
+    const int minimumWidth,
+    const int minimumHeight,
+    const long long minimumModifiedTime)
+{
+    int selectedFileCount = 0;
+
+    for (int fileNameArrayIndex = 0; fileNameArrayIndex < FILE_NAME_ARRAY_SIZE; fileNameArrayIndex++)
+    {
+        unsigned char *pFileName = pFileNameArray[fileNameArrayIndex];
+        pFileNameArray[fileNameArrayIndex] = NULL;
+        if (!pFileName)
+        {
+            continue;
+        }
+
+        const ImageCatalogEntry *pEntry = findImageCatalogEntry((const char *)pFileName);
+        if (!pEntry || !pEntry->isValid)
+        {
+            printf("Skip invalid bitmap file - %s\n", pFileName);
+            free(pFileName);
+            continue;
+        }
+        if (pEntry->width < minimumWidth || pEntry->height < minimumHeight || pEntry->modifiedTime < minimumModifiedTime)
+        {
+            free(pFileName);
+            continue;
+        }
+
+        pFileNameArray[selectedFileCount++] = pFileName;
+    }
+
+    if (sortKey != IMAGE_SORT_NONE)
+    {
+        imageSortKey = sortKey;
+        qsort(pFileNameArray, selectedFileCount, sizeof(unsigned char *), compareCatalogImageFiles);
+    }
+}
+
+// 메타데이터 목록을 파일에 쓰고 매핑을 해제한다.
+void closeImageCatalog()
+{
+    if (!pImageCatalog)
+    {
+        return;
+    }
+
+    msync(pImageCatalog, sizeof(ImageCatalog), MS_SYNC);
+    munmap(pImageCatalog, sizeof(ImageCatalog));
+    pImageCatalog = NULL;
+}
@@ -0,0 +1,409 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <linux/fb.h>
+
+#include "fbbmp.h"
+
+// 이미지 위에 겹쳐 그리는 레이어 목록. 화면 전체에 하나뿐이므로 화면 회전처럼 공유 상태로 둔다.
+static OverlayLayer overlayLayerArray[OVERLAY_LAYER_MAX];
+static int overlayLayerCount = 0;
+
+// 두 사각형을 모두 포함하는 가장 작은 사각형. 빈 사각형(너비나 높이가 0)은 무시한다.
+static DirtyRect unionDirtyRect(
+    const DirtyRect rectA,
+    const DirtyRect rectB)
+{
+    if (rectA.width <= 0 || rectA.height <= 0)
+    {
+        return rectB;
+    }
+    if (rectB.width <= 0 || rectB.height <= 0)
+    {
+        return rectA;
+    }
+
+    DirtyRect unionRect;
+    unionRect.x = MIN(rectA.x, rectB.x);
+    unionRect.y = MIN(rectA.y, rectB.y);
+    unionRect.width = MAX(rectA.x + rectA.width, rectB.x + rectB.width) - unionRect.x;
+    unionRect.height = MAX(rectA.y + rectA.height, rectB.y + rectB.height) - unionRect.y;
+    return unionRect;
+}
+
+// 레이어가 현재 차지하는 화면 영역
+static DirtyRect getOverlayLayerRect(const OverlayLayer *pLayer)
+{
+    const DirtyRect layerRect = {pLayer->x, pLayer->y, pLayer->width, pLayer->height};
+    return layerRect;
+}
+
+// 8비트 알파와 색상을 레이어 픽셀 형식으로 바꾼다.
+// 상위 8비트는 알파, 하위는 프레임 버퍼 형식의 색상이다. 32BPP는 알파를 미리 곱해두어 합성할 때 곱셈을 줄인다.
+unsigned int convertToOverlayPixel(
+    RGBpixel pixel,
+    const unsigned int alpha)
+{
+    if (frameBufferBPP == BPP_16)
+    {
+        return (alpha << 24) | convertRGB24toBGR16(pixel);
+    }
+
+    pixel.blue = (pixel.blue * alpha + 127) / UCHAR_MAX;
+    pixel.green = (pixel.green * alpha + 127) / UCHAR_MAX;
+    pixel.red = (pixel.red * alpha + 127) / UCHAR_MAX;
+    return (alpha << 24) | (convertRGB24toABGR32(pixel) & 0x00FFFFFF);
+}
+
+// 완전히 투명한 빈 레이어를 만든다. x, y가 음수이면 화면 오른쪽, 아래쪽 끝에서부터의 거리이다.
+// 픽셀 배열은 getOverlayLayerPixelArray로 얻어 채우고, 바꾼 뒤에는 markOverlayLayerDirty를 호출한다.
+int createOverlayLayer(
+    const struct fb_var_screeninfo fbvar,
+    const int width,
+    const int height,
+    const int x,
+    const int y)
+{
+    if (overlayLayerCount >= OVERLAY_LAYER_MAX)
+    {
+        printf("Too many overlay layers - max %d\n", OVERLAY_LAYER_MAX);
+        exit(1);
+    }
+
+    OverlayLayer *pLayer = &overlayLayerArray[overlayLayerCount];
+    pLayer->width = width;
+    pLayer->height = height;
+    pLayer->x = (x < 0) ? getScreenWidth(fbvar) - width + x : x;
+    pLayer->y = (y < 0) ? getScreenHeight(fbvar) - height + y : y;
+    pLayer->isVisible = true;
+    pLayer->pPixelArray = (unsigned int *)calloc(width * height, sizeof(unsigned int));
+    if (!pLayer->pPixelArray)
+    {
+        perror("Failed to allocate overlay layer.");
+        exit(1);
+    }
+
+    pLayer->dirtyRect = getOverlayLayerRect(pLayer);
+    return overlayLayerCount++;
+}
+
+// 레이어의 픽셀 배열 (한 행에 width개씩, 위 행부터)
+unsigned int *getOverlayLayerPixelArray(const int layerIndex)
+{
+    return overlayLayerArray[layerIndex].pPixelArray;
+}
+
+// 32비트(알파 포함) 비트맵 파일을 레이어로 읽어온다. x, y가 음수이면 화면 오른쪽, 아래쪽 끝에서부터의 거리이다.
+// 레이어 영역은 다음 compositeOverlayLayers에서 그려진다.
+int addOverlayLayer(
+    const struct fb_var_screeninfo fbvar,
+    const char *pFileName,
+    const int x,
+    const int y)
+{
+    const int fdOverlayInput = open(pFileName, O_RDONLY);
+    if (fdOverlayInput < 0)
+    {
+        perror("Failed to open overlay image file.");
+        exit(1);
+    }
+
+    BMPHeader bitmapHeader;
+    if (read(fdOverlayInput, &bitmapHeader, BITMAP_HEADER_SIZE) != BITMAP_HEADER_SIZE)
+    {
+        perror("Failed to read overlay bitmap header.");
+        exit(1);
+    }
+    if (bitmapHeader.biBitCount != OVERLAY_BITMAP_BPP || bitmapHeader.biWidth <= 0 || bitmapHeader.biHeight == 0
+        || (bitmapHeader.biCompression != BITMAP_COMPRESSION_RGB && bitmapHeader.biCompression != BITMAP_COMPRESSION_BITFIELDS))
+    {
+        printf("Overlay image must be an uncompressed %d-bit bitmap with alpha - %s\n", OVERLAY_BITMAP_BPP, pFileName);
+        exit(1);
+    }
+
+    // 채널 마스크가 있다면 파일의 픽셀이 B, G, R, A 순서인지 확인한다. 알파 마스크는 헤더가 충분히 클 때만 들어있다.
+    if (bitmapHeader.biCompression == BITMAP_COMPRESSION_BITFIELDS)
+    {
+        unsigned int channelMaskArray[4] = {0};
+        const int channelMaskCount = (bitmapHeader.biSize >= BITMAP_ALPHA_MASK_HEADER_SIZE) ? 4 : 3;
+        if (pread(fdOverlayInput, channelMaskArray, sizeof(unsigned int) * channelMaskCount, BITMAP_HEADER_SIZE) != (ssize_t)sizeof(unsigned int) * channelMaskCount)
+        {
+            perror("Failed to read overlay bitmap channel mask.");
+            exit(1);
+        }
+        if (channelMaskArray[0] != 0x00FF0000 || channelMaskArray[1] != 0x0000FF00 || channelMaskArray[2] != 0x000000FF
+            || (channelMaskCount == 4 && channelMaskArray[3] != 0xFF000000))
+        {
+            printf("Overlay image channels must be in B, G, R, A order - %s\n", pFileName);
+            exit(1);
+        }
+    }
+
+    // 높이가 양수이면 아래 행부터, 음수이면 위 행부터 저장되어 있다.
+    const int width = bitmapHeader.biWidth;
+    const int height = abs(bitmapHeader.biHeight);
+    const bool isBottomUp = bitmapHeader.biHeight > 0;
+    const size_t fileRowBytes = (size_t)width * (OVERLAY_BITMAP_BPP / 8);
+    const size_t filePixelBytes = fileRowBytes * height;
+
+    unsigned char *pFilePixelArray = (unsigned char *)malloc(filePixelBytes);
+    if (!pFilePixelArray)
+    {
+        perror("Failed to allocate overlay bitmap pixel.");
+        exit(1);
+    }
+    if (pread(fdOverlayInput, pFilePixelArray, filePixelBytes, bitmapHeader.bfOffBits) != (ssize_t)filePixelBytes)
+    {
+        perror("Failed to read overlay bitmap pixel.");
+        exit(1);
+    }
+    close(fdOverlayInput);
+
+    // 파일의 B, G, R, A 순서 픽셀을 레이어 픽셀 형식으로 바꾼다.
+    const int layerIndex = createOverlayLayer(fbvar, width, height, x, y);
+    unsigned int *pLayerPixelArray = getOverlayLayerPixelArray(layerIndex);
+
+    for (int rowIndex = 0; rowIndex < height; rowIndex++)
+    {
+        const unsigned char *pFileRow = pFilePixelArray + fileRowBytes * (isBottomUp ? height - 1 - rowIndex : rowIndex);
+        for (int columnIndex = 0; columnIndex < width; columnIndex++)
+        {
+            const unsigned char *pFilePixel = pFileRow + columnIndex * (OVERLAY_BITMAP_BPP / 8);
+            const RGBpixel pixel = {pFilePixel[0], pFilePixel[1], pFilePixel[2]};
+            pLayerPixelArray[width * rowIndex + columnIndex] = convertToOverlayPixel(pixel, pFilePixel[3]);
+        }
+    }
+    free(pFilePixelArray);
+
+    return layerIndex;
+}
+
+// 레이어를 보이거나 숨긴다. 레이어 영역만 다시 그리도록 표시한다.
+void setOverlayLayerVisible(
+    const int layerIndex,
+    const bool isVisible)
+{
+    OverlayLayer *pLayer = &overlayLayerArray[layerIndex];
+    if (pLayer->isVisible == isVisible)
+    {
+        return;
+    }
+
+    pLayer->isVisible = isVisible;
+    pLayer->dirtyRect = unionDirtyRect(pLayer->dirtyRect, getOverlayLayerRect(pLayer));
+}
+
+// 레이어의 픽셀 배열을 바꿨음을 알린다. 레이어 영역만 다시 그리도록 표시한다.
+void markOverlayLayerDirty(const int layerIndex)
+{
+    OverlayLayer *pLayer = &overlayLayerArray[layerIndex];
+    pLayer->dirtyRect = unionDirtyRect(pLayer->dirtyRect, getOverlayLayerRect(pLayer));
+}
+
+// 레이어 수
+int getOverlayLayerCount()
+{
+    return overlayLayerCount;
+}
+
+// 보이는 레이어가 있는지 확인한다.
+bool hasVisibleOverlayLayer()
+{
+    for (int layerIndex = 0; layerIndex < overlayLayerCount; layerIndex++)
+    {
+        if (overlayLayerArray[layerIndex].isVisible)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 화면 전체를 다시 그리거나 옮겨서 레이어가 지워졌을 때 모든 레이어 영역을 다시 그리도록 표시한다.
+void invalidateOverlayLayers()
+{
+    for (int layerIndex = 0; layerIndex < overlayLayerCount; layerIndex++)
+    {
+        markOverlayLayerDirty(layerIndex);
+    }
+}
+
+// 화면 내용을 (deltaX, deltaY)만큼 옮긴 뒤 호출한다. 함께 옮겨진 레이어 자국과 원래 레이어 영역을 다시 그리도록 표시한다.
+void scrollOverlayLayers(
+    const int deltaX,
+    const int deltaY)
+{
+    for (int layerIndex = 0; layerIndex < overlayLayerCount; layerIndex++)
+    {
+        OverlayLayer *pLayer = &overlayLayerArray[layerIndex];
+        if (!pLayer->isVisible)
+        {
+            continue;
+        }
+
+        const DirtyRect layerRect = getOverlayLayerRect(pLayer);
+        const DirtyRect scrolledRect = {layerRect.x + deltaX, layerRect.y + deltaY, layerRect.width, layerRect.height};
+        pLayer->dirtyRect = unionDirtyRect(pLayer->dirtyRect, unionDirtyRect(layerRect, scrolledRect));
+    }
+}
+
+// 32BPP 픽셀 한 행에 레이어 한 행을 합성한다. 레이어 색상은 알파를 미리 곱해둔 값이다.
+// 0x00FF00FF로 빨강, 파랑을, 0x0000FF00으로 초록을 분리해서 곱셈 두 번으로 세 채널을 처리한다.
+// 256 - 알파를 곱하고 8비트 시프트하므로 알파가 0이면 원래 값이, 255이면 레이어 색상이 정확히 나온다.
+static void blendOverlayRow32(
+    unsigned int *pDestination,
+    const unsigned int *pOverlayRow,
+    const int width)
+{
+    for (int columnIndex = 0; columnIndex < width; columnIndex++)
+    {
+        const unsigned int overlayPixel = pOverlayRow[columnIndex];
+        const unsigned int alpha = overlayPixel >> 24;
+
+        if (alpha == 0)
+        {
+            continue;
+        }
+        if (alpha == UCHAR_MAX)
+        {
+            pDestination[columnIndex] = overlayPixel & 0x00FFFFFF;
+            continue;
+        }
+
+        const unsigned int inverseAlpha = 256 - alpha;
+        const unsigned int destination = pDestination[columnIndex];
+        const unsigned int redBlue = ((destination & 0x00FF00FF) * inverseAlpha >> 8) & 0x00FF00FF;
+        const unsigned int green = ((destination & 0x0000FF00) * inverseAlpha >> 8) & 0x0000FF00;
+        pDestination[columnIndex] = (overlayPixel & 0x00FFFFFF) + redBlue + green;
+    }
+}
+
+// 16BPP 픽셀 한 행에 레이어 한 행을 합성한다.
+// RGB565를 32비트로 펼쳐(초록을 위쪽 16비트로) 채널 사이에 여유 비트를 만들고, 0~32로 줄인 알파로 세 채널을 한 번에 보간한다.
+// 두 색상의 차이에 알파를 곱하면 음수가 옆 채널로 넘어가므로, 각각 알파와 32 - 알파를 곱해서 더한다. (채널당 최대 11비트)
+static void blendOverlayRow16(
+    unsigned short *pDestination,
+    const unsigned int *pOverlayRow,
+    const int width)
+{
+    for (int columnIndex = 0; columnIndex < width; columnIndex++)
+    {
+        const unsigned int overlayPixel = pOverlayRow[columnIndex];
+        const unsigned int alpha = ((overlayPixel >> 24) + 4) >> 3;   // 0~32로 반올림
+
+        if (alpha == 0)
+        {
+            continue;
+        }
+        if (alpha == 32)
+        {
+            pDestination[columnIndex] = overlayPixel;
+            continue;
+        }
+
+        const unsigned int overlaySpread = ((overlayPixel & 0xFFFF) | (overlayPixel << 16)) & 0x07E0F81F;
+        const unsigned int destinationPixel = pDestination[columnIndex];
+        const unsigned int destinationSpread = (destinationPixel | (destinationPixel << 16)) & 0x07E0F81F;
+        const unsigned int blended = ((overlaySpread * alpha + destinationSpread * (32 - alpha)) >> 5) & 0x07E0F81F;
+        pDestination[columnIndex] = blended | (blended >> 16);
+    }
+}
+
+// 프레임 버퍼 형식으로 변환한 화면 영역(띠)에 보이는 레이어를 순서대로 합성한다.
+// 화면 회전 전의 좌표계에서 합성하므로 프레임 버퍼로 옮길 때 레이어도 함께 회전된다.
+void blendOverlayLayers(
+    unsigned char *pSurface,
+    const int surfaceStride,
+    const int x,
+    const int y,
+    const int width,
+    const int height)
+{
+    const int bytesPerPixel = frameBufferBPP / 8;
+
+    for (int layerIndex = 0; layerIndex < overlayLayerCount; layerIndex++)
+    {
+        const OverlayLayer *pLayer = &overlayLayerArray[layerIndex];
+        if (!pLayer->isVisible)
+        {
+            continue;
+        }
+
+        // 영역과 레이어가 겹치는 부분
+        const int left = MAX(x, pLayer->x);
+        const int top = MAX(y, pLayer->y);
+        const int right = MIN(x + width, pLayer->x + pLayer->width);
+        const int bottom = MIN(y + height, pLayer->y + pLayer->height);
+        if (left >= right || top >= bottom)
+        {
+            continue;
+        }
+
+        for (int screenY = top; screenY < bottom; screenY++)
+        {
+            unsigned char *pDestination = pSurface + surfaceStride * (screenY - y) + (left - x) * bytesPerPixel;
+            const unsigned int *pOverlayRow = pLayer->pPixelArray + pLayer->width * (screenY - pLayer->y) + (left - pLayer->x);
+
+            if (frameBufferBPP == BPP_16)
+            {
+                blendOverlayRow16((unsigned short *)pDestination, pOverlayRow, right - left);
+            }
+            else
+            {
+                blendOverlayRow32((unsigned int *)pDestination, pOverlayRow, right - left);
+            }
+        }
+    }
+}
+
+// 다시 그리도록 표시된 영역만 이미지와 레이어를 합성해서 다시 그린다.
+// 이미지가 없다면(pBitmapHeader가 NULL) 검은 배경 위에 합성한다.
+void compositeOverlayLayers(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    BMPHeader *pBitmapHeader,
+    RGBpixel **pBitmapPixel2dArray,
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport)
+{
+    const int screenWidth = getScreenWidth(fbvar);
+    const int screenHeight = getScreenHeight(fbvar);
+
+    for (int layerIndex = 0; layerIndex < overlayLayerCount; layerIndex++)
+    {
+        OverlayLayer *pLayer = &overlayLayerArray[layerIndex];
+        const DirtyRect dirtyRect = pLayer->dirtyRect;
+        if (dirtyRect.width <= 0 || dirtyRect.height <= 0)
+        {
+            continue;
+        }
+
+        // 화면 밖은 잘라낸다.
+        const int left = MAX(0, dirtyRect.x);
+        const int top = MAX(0, dirtyRect.y);
+        const int right = MIN(screenWidth, dirtyRect.x + dirtyRect.width);
+        const int bottom = MIN(screenHeight, dirtyRect.y + dirtyRect.height);
+
+        drawImageRegionOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, pColorLUT, pViewport,
+            left, top, right - left, bottom - top);
+
+        pLayer->dirtyRect.width = 0;
+        pLayer->dirtyRect.height = 0;
+    }
+}
+
+// 프레임 버퍼를 비우고 검은 배경 위에 레이어를 다시 그린다.
+// 화면 전체를 지우는 곳은 레이어(로고, 시계, 화면 정보)가 지워진 채로 남지 않도록 clearFrameBuffer 대신 이 함수를 사용한다.
+void clearFrameBufferUnderOverlays(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport)
+{
+    clearFrameBuffer(pfbmap, fbvar);
+    invalidateOverlayLayers();
+    compositeOverlayLayers(pfbmap, fbvar, NULL, NULL, pColorLUT, pViewport);
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <linux/fb.h>
+#include <sys/mman.h>
+
+#include "fbbmp.h"
+
+// 프레임 내보내기의 공유 상태
+static const char *pFrameExportName = NULL;         // 공유 메모리 이름 (NULL이면 내보내지 않는다.)
+static FrameExportHeader *pFrameExportHeader = NULL;// 공유 메모리 시작 주소 (헤더 뒤에 프레임 칸들이 이어진다.)
+static size_t frameExportSize = 0;                  // 공유 메모리 전체 크기
+static int frameExportFrameBytes = 0;               // 프레임 하나의 바이트 수
+
+// 페이지 크기의 배수로 올린다.
+static size_t alignToPage(const size_t size)
+{
+    const size_t pageSize = sysconf(_SC_PAGESIZE);
+    return (size + pageSize - 1) / pageSize * pageSize;
+}
+
+// POSIX 공유 메모리에 프레임 링을 만든다. 다른 프로세스는 같은 이름으로 읽기 전용 매핑해서 최신 프레임을 읽는다.
+void initFrameExport(
+    const char *pName,
+    const struct fb_var_screeninfo fbvar)
+{
+    frameExportFrameBytes = calculateFrameBufferSize(fbvar);
+
+    const size_t headerSize = alignToPage(sizeof(FrameExportHeader));
+    const size_t slotSize = alignToPage(frameExportFrameBytes);
+    frameExportSize = headerSize + slotSize * FRAME_EXPORT_SLOT_COUNT;
+
+    const int fdSharedMemory = shm_open(pName, O_CREAT | O_RDWR, 0644);
+    if (fdSharedMemory < 0)
+    {
+        perror("Failed to open shared memory for frame export.");
+        exit(1);
+    }
+    if (ftruncate(fdSharedMemory, frameExportSize) < 0)
+    {
+        perror("Failed to resize shared memory for frame export.");
+        exit(1);
+    }
+
+    pFrameExportHeader = (FrameExportHeader *)mmap(0, frameExportSize, PROT_READ | PROT_WRITE, MAP_SHARED, fdSharedMemory, 0);
+    close(fdSharedMemory);
+    if (pFrameExportHeader == (FrameExportHeader *)MAP_FAILED)
+    {
+        perror("Failed to map shared memory for frame export.");
+        exit(1);
+    }
+
+    // 헤더를 채운다. 매직 넘버는 마지막에 써서 읽는 쪽이 덜 채워진 헤더를 보지 않게 한다.
+    memset(pFrameExportHeader, 0, headerSize);
+    pFrameExportHeader->version = FRAME_EXPORT_VERSION;
+    pFrameExportHeader->headerSize = headerSize;
+    pFrameExportHeader->slotCount = FRAME_EXPORT_SLOT_COUNT;
+    pFrameExportHeader->slotSize = slotSize;
+    pFrameExportHeader->width = fbvar.xres_virtual;
+    pFrameExportHeader->height = fbvar.yres_virtual;
+    pFrameExportHeader->stride = calculateFrameBufferLineLength(fbvar);
+    pFrameExportHeader->bitsPerPixel = frameBufferBPP;
+    pFrameExportHeader->rotation = displayRotation;
+    __atomic_store_n(&pFrameExportHeader->magic, FRAME_EXPORT_MAGIC, __ATOMIC_RELEASE);
+
+    pFrameExportName = pName;
+}
+
+// 현재 프레임 버퍼를 링의 다음 칸에 복사하고 최신 프레임 번호를 올린다.
+// 칸마다 시퀀스 락을 사용하므로 읽는 쪽을 기다리지 않는다. 읽는 쪽은 읽기 전후의 칸 번호가 같을 때만 결과를 사용한다.
+void publishFrame(const unsigned int *pfbmap)
+{
+    if (!pFrameExportName)
+    {
+        return;
+    }
+
+    const unsigned long long frameNumber = pFrameExportHeader->latestFrame + 1;
+    FrameExportSlot *pSlot = &pFrameExportHeader->slotArray[frameNumber % FRAME_EXPORT_SLOT_COUNT];
+    unsigned char *pSlotData = (unsigned char *)pFrameExportHeader + pFrameExportHeader->headerSize
+        + (size_t)pFrameExportHeader->slotSize * (frameNumber % FRAME_EXPORT_SLOT_COUNT);
+
+    // 홀수 : 쓰는 중. 이후의 프레임 쓰기보다 먼저 보이도록 한다.
+    __atomic_store_n(&pSlot->sequence, frameNumber * 2 - 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(pSlotData, pfbmap, frameExportFrameBytes);
+    pSlot->timestamp = getMonotonicTime();
+
+    // 짝수 : 프레임 번호 * 2로 완성. 그 다음에 최신 프레임 번호를 올린다.
+    __atomic_store_n(&pSlot->sequence, frameNumber * 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&pFrameExportHeader->latestFrame, frameNumber, __ATOMIC_RELEASE);
+}
+
+// 공유 메모리를 해제하고 이름을 지운다.
+void closeFrameExport()
+{
+    if (!pFrameExportName)
+    {
+        return;
+    }
+
+    munmap(pFrameExportHeader, frameExportSize);
+    shm_unlink(pFrameExportName);
+    pFrameExportHeader = NULL;
+    pFrameExportName = NULL;
+}
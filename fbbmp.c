@@ -16,38 +16,414 @@
 unsigned char quit = 0;          // 무한 반복문 종료를 위한 변수
 int frameBufferBPP = BPP_32;     // 프레임 버퍼의 BPP를 설정하기 위한 변수
 bool isDeviceConnected = false;  // 장치가 연결되어 있는지 확인하기 위한 변수
+int displayRotation = ROTATION_0;// 화면 회전 각도 (0, 90, 180, 270)
+int ditherMatrixSize = DITHER_NONE;// 16BPP 순서 디더링의 Bayer 행렬 크기
 
 // 매개변수가 없을 시 32BPP로, 실제 장치와 관계 없이 콘솔에서만 동작한다.
 int main(int argc, char* argv[])
 {
-    // 1번 매개변수를 통해 16BPP 모드로 전환한다. 하드웨어가 지원하지 않을 경우 사용할 수 없다.
-    if (argc >= 2)
+    // 색상 조정 값 (대비, 감마, 레벨은 옵션으로 지정하고 밝기는 4, 5번 버튼으로 조절한다.)
+    ColorAdjustment colorAdjustment;
+    initColorAdjustment(&colorAdjustment);
+    bool isAutoLevels = false;  // 이미지를 열 때마다 히스토그램으로 레벨을 정한다.
+
+    // 미리 변환 모드 관련 (--prerender를 지정하면 화면 없이 변환만 하고 종료한다.)
+    const char *pPrerenderPath = NULL;
+    int jobCount = sysconf(_SC_NPROCESSORS_ONLN);  // 미리 변환, 연속 재생의 디코딩에 사용할 스레드 수
+    int prerenderWidth = 0;
+    int prerenderHeight = 0;
+
+    // 연속 재생 모드 관련 (--play를 지정하면 번호가 붙은 파일들을 재생하고 종료한다.)
+    const char *pPlaybackPattern = NULL;
+    int playbackFramesPerSecond = PLAYBACK_DEFAULT_FPS;
+    int playbackLoopCount = 0;
+    long long playbackMemoryBudget = (long long)PLAYBACK_DEFAULT_MEMORY_MB << 20;
+
+    // 파일 읽기, 쓰기에 사용할 비동기 I/O 엔진 (io_uring을 사용할 수 없으면 스레드 풀로 대신한다.)
+    int asyncIOEngine = ASYNC_IO_ENGINE_IO_URING;
+
+    // 이미지, 화면 크기 버퍼를 다시 쓰는 버퍼 풀의 메모리 한도와 큰 페이지, mlock 사용 여부
+    long long bufferPoolBudget = (long long)BUFFER_POOL_DEFAULT_MEMORY_MB << 20;
+    bool isHugePageEnabled = false;
+    bool isMemoryLockEnabled = false;
+
+    // 읽기, 출력, 캡처마다 성능 카운터를 출력한다.
+    bool isProfiling = false;
+
+    // 입력 기록, 재생과 가상 프레임 버퍼 (장치 없이 같은 입력을 반복해서 시험한다.)
+    int inputTraceMode = INPUT_TRACE_NONE;
+    const char *pInputTraceFileName = NULL;
+    bool isReplayMaxSpeed = false;
+    int virtualFrameBufferWidth = 0;
+    int virtualFrameBufferHeight = 0;
+
+    // 화면을 내보낼 공유 메모리 이름 (NULL이면 내보내지 않는다.)
+    const char *pFrameExportName = NULL;
+
+    // 이미지 위에 겹쳐 그릴 레이어 (FILE@X,Y 형식, 프레임 버퍼를 연 뒤에 읽는다.)
+    const char *pOverlayOptionArray[OVERLAY_LAYER_MAX] = {0};
+    int overlayOptionCount = 0;
+
+    // 파일 목록의 정렬 기준과 조건 (메타데이터 목록으로 파일을 열지 않고 고른다.)
+    int imageSortKey = IMAGE_SORT_NONE;
+    int minimumImageWidth = 0;
+    int minimumImageHeight = 0;
+    long long minimumModifiedTime = 0;
+
+    // 파일명, 해상도, BPP를 화면 왼쪽 아래에도 표시한다. (Text LCD가 없는 장치용)
+    bool isInfoDisplayed = false;
+    bool isClockDisplayed = false;      // 화면 오른쪽 위에 시계를 표시하고 1초마다 시계 영역만 다시 그린다.
+
+    // '--'로 시작하는 인자는 옵션이고, 나머지는 순서대로 1번, 2번 매개변수이다.
+    int positionalArgumentCount = 0;
+    for (int argumentIndex = 1; argumentIndex < argc; argumentIndex++)
     {
-        if (atoi(argv[1]) == BPP_16 || atoi(argv[1]) == BPP_32)
+        const char *pArgument = argv[argumentIndex];
+        const char *pOptionValue = NULL;
+
+        // 대비를 백분율로 지정한다. (100 = 원본)
+        if ((pOptionValue = matchCommandLineOption(pArgument, "--contrast")))
         {
-            frameBufferBPP = atoi(argv[1]);
+            colorAdjustment.contrast = thresholding(atoi(pOptionValue), 0, 1000);
         }
-        else
+        // 감마를 지정한다. (1.0 = 원본)
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--gamma")))
         {
-            printf("Invalid argument 1 - ex) ./fbbmp 16\n");
-            exit(1);
+            colorAdjustment.gamma = atof(pOptionValue);
+            if (colorAdjustment.gamma <= 0)
+            {
+                printf("Invalid gamma - ex) --gamma=1.8\n");
+                exit(1);
+            }
         }
-    }
+        // 입력 레벨 범위를 지정한다. --levels는 모든 채널, --levels-red 등은 해당 채널에만 적용한다.
+        else if (!strncmp(pArgument, "--levels", strlen("--levels")))
+        {
+            const char *pChannelNames[COLOR_CHANNEL_COUNT] = {"--levels-blue", "--levels-green", "--levels-red"};
+            const char *pAllChannelsValue = matchCommandLineOption(pArgument, "--levels");
+            int levelLow = 0;
+            int levelHigh = 0;
+            bool isMatched = false;
 
-    // 2번 매개변수를 통해 실제 장치가 연결되었을 때와 동일하게 동작하도록 한다.
-    if (argc >= 3)
-    {
-        if (!strcmp(argv[2], "device"))
+            for (int channel = 0; channel < COLOR_CHANNEL_COUNT; channel++)
+            {
+                pOptionValue = pAllChannelsValue ? pAllChannelsValue : matchCommandLineOption(pArgument, pChannelNames[channel]);
+                if (!pOptionValue)
+                {
+                    continue;
+                }
+                if (sscanf(pOptionValue, "%d:%d", &levelLow, &levelHigh) != 2 || levelLow < UCHAR_MIN || levelHigh > UCHAR_MAX || levelLow >= levelHigh)
+                {
+                    printf("Invalid levels - ex) --levels=16:235\n");
+                    exit(1);
+                }
+                colorAdjustment.levelsLow[channel] = levelLow;
+                colorAdjustment.levelsHigh[channel] = levelHigh;
+                isMatched = true;
+            }
+
+            if (!isMatched)
+            {
+                printf("Invalid option - %s\n", pArgument);
+                exit(1);
+            }
+        }
+        // 이미지를 읽으면서 센 히스토그램으로 채널별 레벨을 자동으로 정한다. (--levels 대신 사용)
+        else if (!strcmp(pArgument, "--auto-levels"))
+        {
+            isAutoLevels = true;
+        }
+        // 읽기, 출력, 캡처의 하드웨어 성능 카운터를 측정해서 출력한다.
+        else if (!strcmp(pArgument, "--profile"))
+        {
+            isProfiling = true;
+        }
+        // 입력(버튼 또는 콘솔)을 시각과 함께 파일에 기록한다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--record")))
+        {
+            inputTraceMode = INPUT_TRACE_RECORD;
+            pInputTraceFileName = pOptionValue;
+        }
+        // 기록한 입력을 파일에서 읽어 재생하고 입력별 처리 시간을 출력한다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--replay")))
+        {
+            inputTraceMode = INPUT_TRACE_REPLAY;
+            pInputTraceFileName = pOptionValue;
+        }
+        // 재생 속도를 지정한다. (original : 기록된 간격, max : 간격 없이)
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--replay-speed")))
+        {
+            if (strcmp(pOptionValue, "original") && strcmp(pOptionValue, "max"))
+            {
+                printf("Invalid replay speed - ex) --replay-speed=max\n");
+                exit(1);
+            }
+            isReplayMaxSpeed = !strcmp(pOptionValue, "max");
+        }
+        // 프레임 버퍼 장치 대신 지정한 해상도의 메모리에 출력한다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--virtual-fb")))
+        {
+            if (sscanf(pOptionValue, "%dx%d", &virtualFrameBufferWidth, &virtualFrameBufferHeight) != 2 || virtualFrameBufferWidth <= 0 || virtualFrameBufferHeight <= 0)
+            {
+                printf("Invalid resolution - ex) --virtual-fb=1024x600\n");
+                exit(1);
+            }
+        }
+        // 명령을 처리할 때마다 화면을 POSIX 공유 메모리(/dev/shm/NAME)로 내보낸다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--export")))
+        {
+            pFrameExportName = (*pOptionValue) ? pOptionValue : FRAME_EXPORT_DEFAULT_NAME;
+        }
+        // 32비트(알파 포함) 비트맵을 화면의 X, Y 위치에 겹쳐 그린다. 여러 번 지정할 수 있다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--overlay")))
+        {
+            if (!*pOptionValue || overlayOptionCount >= OVERLAY_LAYER_MAX)
+            {
+                printf("Invalid overlay - ex) --overlay=logo.bmp@-10,10 (max %d)\n", OVERLAY_LAYER_MAX);
+                exit(1);
+            }
+            pOverlayOptionArray[overlayOptionCount++] = pOptionValue;
+        }
+        // 파일명, 해상도, BPP, 배율을 프레임 버퍼에 글자로 표시한다.
+        else if (!strcmp(pArgument, "--info"))
+        {
+            isInfoDisplayed = true;
+        }
+        // 현재 시각을 프레임 버퍼에 글자로 표시한다.
+        else if (!strcmp(pArgument, "--clock"))
+        {
+            isClockDisplayed = true;
+        }
+        // 파일 목록의 정렬 기준을 지정한다. (name, resolution, date)
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--sort")))
+        {
+            if (!strcmp(pOptionValue, "name"))
+            {
+                imageSortKey = IMAGE_SORT_NAME;
+            }
+            else if (!strcmp(pOptionValue, "resolution"))
+            {
+                imageSortKey = IMAGE_SORT_RESOLUTION;
+            }
+            else if (!strcmp(pOptionValue, "date"))
+            {
+                imageSortKey = IMAGE_SORT_DATE;
+            }
+            else
+            {
+                printf("Invalid sort - ex) --sort=date\n");
+                exit(1);
+            }
+        }
+        // 가로, 세로가 모두 지정한 크기 이상인 이미지만 연다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--min-resolution")))
+        {
+            if (sscanf(pOptionValue, "%dx%d", &minimumImageWidth, &minimumImageHeight) != 2 || minimumImageWidth < 0 || minimumImageHeight < 0)
+            {
+                printf("Invalid resolution - ex) --min-resolution=640x480\n");
+                exit(1);
+            }
+        }
+        // 지정한 날짜(현지 시각 0시) 이후에 수정된 이미지만 연다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--after")))
+        {
+            struct tm afterDate = {0};
+            if (sscanf(pOptionValue, "%d-%d-%d", &afterDate.tm_year, &afterDate.tm_mon, &afterDate.tm_mday) != 3)
+            {
+                printf("Invalid date - ex) --after=2024-01-31\n");
+                exit(1);
+            }
+            afterDate.tm_year -= 1900;
+            afterDate.tm_mon -= 1;
+            afterDate.tm_isdst = -1;
+            minimumModifiedTime = (long long)mktime(&afterDate) * 1000000000LL;
+        }
+        // 화면을 시계 방향으로 회전해서 출력한다. (세로로 설치한 패널)
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--rotate")))
+        {
+            displayRotation = atoi(pOptionValue);
+            if (displayRotation != ROTATION_0 && displayRotation != ROTATION_90 && displayRotation != ROTATION_180 && displayRotation != ROTATION_270)
+            {
+                printf("Invalid rotation - ex) --rotate=90\n");
+                exit(1);
+            }
+        }
+        // 16BPP로 변환할 때 하위 비트를 버리지 않고 Bayer 행렬로 순서 디더링한다. (값이 없으면 8x8)
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--dither")))
+        {
+            if (!*pOptionValue || !strcmp(pOptionValue, "8"))
+            {
+                ditherMatrixSize = DITHER_BAYER_8;
+            }
+            else if (!strcmp(pOptionValue, "4"))
+            {
+                ditherMatrixSize = DITHER_BAYER_4;
+            }
+            else if (!strcmp(pOptionValue, "off"))
+            {
+                ditherMatrixSize = DITHER_NONE;
+            }
+            else
+            {
+                printf("Invalid dither - ex) --dither=4\n");
+                exit(1);
+            }
+        }
+        // 경로 안의 비트맵 파일을 프레임 버퍼 형식으로 미리 변환한다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--prerender")))
+        {
+            pPrerenderPath = (*pOptionValue) ? pOptionValue : ".";
+        }
+        // 미리 변환, 연속 재생의 디코딩에 사용할 스레드 수를 지정한다. (기본값은 CPU 코어 수)
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--jobs")))
+        {
+            jobCount = atoi(pOptionValue);
+        }
+        // 번호가 붙은 비트맵 파일들(예: frame%04d.bmp)을 연속 재생한다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--play")))
+        {
+            pPlaybackPattern = pOptionValue;
+        }
+        // 연속 재생의 초당 프레임 수를 지정한다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--fps")))
+        {
+            playbackFramesPerSecond = atoi(pOptionValue);
+            if (playbackFramesPerSecond <= 0 || playbackFramesPerSecond > 1000)
+            {
+                printf("Invalid fps - ex) --fps=30\n");
+                exit(1);
+            }
+        }
+        // 연속 재생의 반복 횟수를 지정한다. (기본값 0 : 종료할 때까지 반복)
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--play-loops")))
+        {
+            playbackLoopCount = MAX(0, atoi(pOptionValue));
+        }
+        // 연속 재생 프레임에 사용할 메모리 한도를 MB 단위로 지정한다. 모든 프레임이 들어가면 파일을 한 번만 읽는다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--play-memory")))
+        {
+            playbackMemoryBudget = (long long)MAX(0, atoi(pOptionValue)) << 20;
+        }
+        // 미리 변환할 프레임 버퍼 해상도를 지정한다. (기본값은 현재 프레임 버퍼 해상도)
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--resolution")))
+        {
+            if (sscanf(pOptionValue, "%dx%d", &prerenderWidth, &prerenderHeight) != 2 || prerenderWidth <= 0 || prerenderHeight <= 0)
+            {
+                printf("Invalid resolution - ex) --resolution=1024x600\n");
+                exit(1);
+            }
+        }
+        // 비동기 I/O 엔진을 지정한다. (uring, threads, off)
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--async-io")))
+        {
+            if (!strcmp(pOptionValue, "uring"))
+            {
+                asyncIOEngine = ASYNC_IO_ENGINE_IO_URING;
+            }
+            else if (!strcmp(pOptionValue, "threads"))
+            {
+                asyncIOEngine = ASYNC_IO_ENGINE_THREAD_POOL;
+            }
+            else if (!strcmp(pOptionValue, "off"))
+            {
+                asyncIOEngine = ASYNC_IO_ENGINE_SYNC;
+            }
+            else
+            {
+                printf("Invalid async I/O engine - ex) --async-io=threads\n");
+                exit(1);
+            }
+        }
+        // 버퍼 풀이 매핑해둘 수 있는 메모리 한도를 MB 단위로 지정한다. 한도 안에서는 버퍼를 해제하지 않고 다시 쓴다.
+        else if ((pOptionValue = matchCommandLineOption(pArgument, "--pool-memory")))
+        {
+            bufferPoolBudget = (long long)MAX(0, atoi(pOptionValue)) << 20;
+        }
+        // 큰 버퍼를 큰 페이지(hugetlbfs, 없으면 THP)로 매핑해서 TLB 미스와 페이지 폴트를 줄인다.
+        else if (!strcmp(pArgument, "--huge-pages"))
         {
-            isDeviceConnected = true;
+            isHugePageEnabled = true;
+        }
+        // 버퍼 풀의 메모리를 mlock으로 고정해서 스왑되지 않게 한다.
+        else if (!strcmp(pArgument, "--lock-memory"))
+        {
+            isMemoryLockEnabled = true;
+        }
+        else if (!strncmp(pArgument, "--", 2))
+        {
+            printf("Invalid option - %s\n", pArgument);
+            exit(1);
+        }
+        // 1번 매개변수를 통해 16BPP 모드로 전환한다. 하드웨어가 지원하지 않을 경우 사용할 수 없다.
+        else if (positionalArgumentCount == 0)
+        {
+            if (atoi(pArgument) == BPP_16 || atoi(pArgument) == BPP_32)
+            {
+                frameBufferBPP = atoi(pArgument);
+            }
+            else
+            {
+                printf("Invalid argument 1 - ex) ./fbbmp 16\n");
+                exit(1);
+            }
+            positionalArgumentCount++;
+        }
+        // 2번 매개변수를 통해 실제 장치가 연결되었을 때와 동일하게 동작하도록 한다.
+        else if (positionalArgumentCount == 1)
+        {
+            if (!strcmp(pArgument, "device"))
+            {
+                isDeviceConnected = true;
+            }
+            else
+            {
+                printf("Invalid argument 2 - ex) ./fbbmp 32 device\n");
+                exit(1);
+            }
+            positionalArgumentCount++;
         }
         else
         {
-            printf("Invalid argument 2 - ex) ./fbbmp 32 device\n");
+            printf("Too many arguments - %s\n", pArgument);
             exit(1);
         }
     }
 
+    initBufferPool(bufferPoolBudget, isHugePageEnabled, isMemoryLockEnabled);
+    buildDitherTable(ditherMatrixSize);
+    if (isProfiling)
+    {
+        initProfiler();
+    }
+    initAsyncIO(asyncIOEngine);
+    printf("Async I/O : %s\n", getAsyncIOEngineName());
+
+    // 미리 변환 모드는 장치를 열지 않고 변환만 한 뒤 종료한다.
+    if (pPrerenderPath)
+    {
+        struct fb_var_screeninfo prerenderFbvar = {0};
+        prerenderFbvar.xres_virtual = prerenderWidth;
+        prerenderFbvar.yres_virtual = prerenderHeight;
+
+        // 해상도를 지정하지 않았다면 프레임 버퍼에서 읽어온다.
+        if (!prerenderWidth)
+        {
+            int fdFrameBuffer = open(DEVICE_FRAME_BUFFER, O_RDONLY);
+            if (fdFrameBuffer < 0 || ioctl(fdFrameBuffer, FBIOGET_VSCREENINFO, &prerenderFbvar) < 0)
+            {
+                perror("Failed to get frame buffer resolution. Use --resolution");
+                exit(1);
+            }
+            close(fdFrameBuffer);
+        }
+
+        const int prerenderResult = prerenderImagesInPath(pPrerenderPath, prerenderFbvar, jobCount) ? 1 : 0;
+        closeAsyncIO();
+        printBufferPoolStatistics();
+        closeBufferPool();
+        return prerenderResult;
+    }
+
     int pushSwitchIndex = 0;    // 지속적으로 푸시 스위치를 스캔해서 눌린 버튼을 찾는다.
     unsigned char pushSwitchBuffer[PUSH_SWITCH_BUFFER_SIZE] = {0};      // 버튼이 눌리면 값이 1로 변한다.
     unsigned char textLCDBuffer[TEXT_LCD_HEIGHT][TEXT_LCD_WIDTH] = {0}; // 파일명, 해상도 및 BPP(Bits Per Pixel)를 표시한다.
@@ -80,73 +456,199 @@ int main(int argc, char* argv[])
     // 무한 반복문을 종료하기 위한 시그널 등록
     (void)signal(SIGINT, signalCallbackQuit);
 
-    // 프레임 버퍼 열기
-    int fdFrameBuffer = open(DEVICE_FRAME_BUFFER, O_RDWR);
-    if (fdFrameBuffer < 0)
+    // 프레임 버퍼 장치 또는 메모리에 만든 가상 프레임 버퍼
+    int fdFrameBuffer = -1;
+    struct fb_var_screeninfo fbvar = {0};
+    unsigned int *pfbmap = NULL;
+
+    // 가상 프레임 버퍼는 장치 없이 같은 형식의 메모리에 출력한다. (재생 시험, 성능 측정용)
+    if (virtualFrameBufferWidth)
     {
-        perror("Failed to open driver - Frame buffer");
-        exit(1);
-    }
+        fbvar.xres = fbvar.xres_virtual = virtualFrameBufferWidth;
+        fbvar.yres = fbvar.yres_virtual = virtualFrameBufferHeight;
+        fbvar.bits_per_pixel = frameBufferBPP;
 
-    // 프레임 버퍼 가변 정보 얻어오기
-    struct fb_var_screeninfo fbvar;
-    if (ioctl(fdFrameBuffer, FBIOGET_VSCREENINFO, &fbvar) < 0)
+        pfbmap = (unsigned int *)mmap(0, calculateFrameBufferSize(fbvar), PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if (pfbmap == (unsigned int *)-1)
+        {
+            perror("Failed to allocate virtual frame buffer.");
+            exit(1);
+        }
+    }
+    else
     {
-        perror("Failed to get variable screen info of frame buffer.");
-        exit(1);
+        // 프레임 버퍼 열기
+        fdFrameBuffer = open(DEVICE_FRAME_BUFFER, O_RDWR);
+        if (fdFrameBuffer < 0)
+        {
+            perror("Failed to open driver - Frame buffer");
+            exit(1);
+        }
+
+        // 프레임 버퍼 가변 정보 얻어오기
+        if (ioctl(fdFrameBuffer, FBIOGET_VSCREENINFO, &fbvar) < 0)
+        {
+            perror("Failed to get variable screen info of frame buffer.");
+            exit(1);
+        }
+
+        // 프레임 버퍼의 BPP를 변경
+        fbvar.bits_per_pixel = frameBufferBPP;
+        if (ioctl(fdFrameBuffer, FBIOPUT_VSCREENINFO, &fbvar) < 0)
+        {
+            perror("Failed to set BPP by ioctl.");
+            exit(1);
+        }
+
+        // 변경되지 않은 경우 처리
+        if (fbvar.bits_per_pixel != frameBufferBPP)
+        {
+            perror("BPP is not changed.");
+            exit(1);
+        }
+
+        // 프레임 버퍼 크기만큼 디바이스 메모리 주소와 포인터의 메모리 주소를 연결한다.
+        pfbmap = (unsigned int *)mmap(
+            0,                                  // 할당 받고자 하는 메모리 주소 (0을 지정하면 커널에 의해 임의로 할당된 주소를 받는다.)
+            calculateFrameBufferSize(fbvar),    // 프레임 버퍼 크기
+            PROT_READ|PROT_WRITE,               // 매핑된 파일에 읽기, 쓰기를 허용
+            MAP_SHARED,                         // 다른 프로세스와 매핑을 공유하는 옵션
+            fdFrameBuffer,                      // 프레임 버퍼 드라이버 파일 디스크립터 (/dev/fb0)
+            0);                                 // 오프셋 (0 ~ 프레임 버퍼 크기까지 매핑)
+
+        if (pfbmap == (unsigned int *)-1)
+        {
+            perror("Failed to map frame buffer to memory.");
+            exit(1);
+        }
     }
 
-    // 프레임 버퍼의 BPP를 변경
-    fbvar.bits_per_pixel = frameBufferBPP;
-    if (ioctl(fdFrameBuffer, FBIOPUT_VSCREENINFO, &fbvar) < 0)
+    // 프레임 버퍼를 초기화한다.
+    clearFrameBuffer(pfbmap, fbvar);
+
+    // 레이어를 읽어온다. 위치를 생략하면 왼쪽 위에, 음수이면 오른쪽, 아래쪽 끝에서부터 놓는다.
+    for (int overlayIndex = 0; overlayIndex < overlayOptionCount; overlayIndex++)
     {
-        perror("Failed to set BPP by ioctl.");
-        exit(1);
+        char overlayFileName[FILE_NAME_MAX_LENGTH] = {0};
+        int overlayX = 0;
+        int overlayY = 0;
+
+        const char *pPosition = strrchr(pOverlayOptionArray[overlayIndex], '@');
+        const int fileNameLength = pPosition ? pPosition - pOverlayOptionArray[overlayIndex] : (int)strlen(pOverlayOptionArray[overlayIndex]);
+        if (fileNameLength >= FILE_NAME_MAX_LENGTH || (pPosition && sscanf(pPosition + 1, "%d,%d", &overlayX, &overlayY) != 2))
+        {
+            printf("Invalid overlay - %s\n", pOverlayOptionArray[overlayIndex]);
+            exit(1);
+        }
+        memcpy(overlayFileName, pOverlayOptionArray[overlayIndex], fileNameLength);
+        addOverlayLayer(fbvar, overlayFileName, overlayX, overlayY);
     }
+    bool isOverlayVisible = true;           // 콘솔의 o로 모든 레이어를 숨기거나 다시 보인다.
 
-    // 변경되지 않은 경우 처리
-    if (fbvar.bits_per_pixel != frameBufferBPP)
+    // 화면 정보는 Text LCD와 같이 두 줄로, 화면 너비에 맞는 글자 수만큼 표시한다.
+    int infoTextIndexArray[TEXT_LCD_HEIGHT] = {0};
+    char infoText[TEXT_OVERLAY_MAX_COLUMN + 1] = {0};
+    if (isInfoDisplayed)
     {
-        perror("BPP is not changed.");
-        exit(1);
+        const int infoColumnCount = MIN(TEXT_OVERLAY_MAX_COLUMN,
+            (getScreenWidth(fbvar) - TEXT_INFO_MARGIN * 2 - TEXT_OVERLAY_SCALE) / (TEXT_CELL_WIDTH * TEXT_OVERLAY_SCALE));
+        for (int lineIndex = 0; lineIndex < TEXT_LCD_HEIGHT; lineIndex++)
+        {
+            const int lineY = -TEXT_INFO_MARGIN - (TEXT_LCD_HEIGHT - 1 - lineIndex) * TEXT_CELL_HEIGHT * TEXT_OVERLAY_SCALE;
+            infoTextIndexArray[lineIndex] = addTextOverlay(fbvar, infoColumnCount, TEXT_INFO_MARGIN, lineY);
+        }
     }
 
-    // 프레임 버퍼 크기만큼 디바이스 메모리 주소와 포인터의 메모리 주소를 연결한다.
-    unsigned int *pfbmap = (unsigned int *)mmap(
-        0,                                  // 할당 받고자 하는 메모리 주소 (0을 지정하면 커널에 의해 임의로 할당된 주소를 받는다.)
-        calculateFrameBufferSize(fbvar),    // 프레임 버퍼 크기
-        PROT_READ|PROT_WRITE,               // 매핑된 파일에 읽기, 쓰기를 허용
-        MAP_SHARED,                         // 다른 프로세스와 매핑을 공유하는 옵션
-        fdFrameBuffer,                      // 프레임 버퍼 드라이버 파일 디스크립터 (/dev/fb0)
-        0);                                 // 오프셋 (0 ~ 프레임 버퍼 크기까지 매핑)
-
-    if (pfbmap == (unsigned int *)-1)
+    // 시계는 화면 오른쪽 위에 표시한다. 콘솔 입력을 1초씩 기다리며 갱신하므로 표준 입력을 버퍼 없이 사용한다.
+    int clockTextIndex = -1;
+    if (isClockDisplayed)
     {
-        perror("Failed to map frame buffer to memory.");
-        exit(1);
+        clockTextIndex = addTextOverlay(fbvar, CLOCK_TEXT_COLUMN_COUNT, -TEXT_INFO_MARGIN, TEXT_INFO_MARGIN);
+        updateClockOverlay(clockTextIndex);
+        setvbuf(stdin, NULL, _IONBF, 0);
     }
 
-    // 프레임 버퍼를 초기화한다.
-    clearFrameBuffer(pfbmap, fbvar);
-
     // 비트맵 이미지 관련
     BMPHeader *pBitmapHeader = NULL;        // 입력 비트맵 헤더 구조체
     RGBpixel **pBitmapPixel2dArray = NULL;  // RGB 각 8비트로 구성된 24비트 픽셀
     int fileIndex = -1;                     // 1, 2번 버튼으로 다루게 될 pFileNameArray 배열의 인덱스
-    int brightness = 0;                     // 4, 5번 버튼으로 조절할 픽셀의 밝기
+    ColorLUT colorLUT;                      // 색상 조정과 BPP 변환을 합친 채널별 변환 테이블
+    Viewport viewport;                      // 7, 8번 버튼으로 확대/축소하고 이동 모드에서 옮길 화면 영역
+    bool isPanMode = false;                 // 9번 버튼으로 켜고 끄는 이동 모드
+    bool isPrerenderDisplayed = false;      // 미리 변환한 파일을 출력해서 원본 이미지를 아직 읽지 않은 상태
+    ProfileSample profileSample;            // --profile 측정 시작 시점의 카운터 값
+    const long long screenPixelCount = (long long)getScreenWidth(fbvar) * getScreenHeight(fbvar);
+    ColorHistogram colorHistogram;          // 자동 레벨에 사용할 채널별 히스토그램
+
+    initViewport(&viewport);
+
+    buildColorLUT(&colorLUT, &colorAdjustment);
+
+    // 이미지가 없으므로 검은 화면 위에 레이어만 그린다.
+    compositeOverlayLayers(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, &colorLUT, &viewport);
 
     // 비트맵 확장자를 가진 파일 목록 수집
     unsigned char *pFileNameArray[FILE_NAME_ARRAY_SIZE] = {0};
     searchFilesInPathByExtention(pFileNameArray, ".", BITMAP_EXTENSION);
 
+    // 메타데이터 목록을 갱신해서 읽을 수 없는 파일을 빼고 조건에 맞게 고르고 정렬한다.
+    openImageCatalog(".");
+    updateImageCatalog(pFileNameArray);
+    selectCatalogImageFiles(pFileNameArray, imageSortKey, minimumImageWidth, minimumImageHeight, minimumModifiedTime);
+
     // 프로그램 사용법을 콘솔에 출력한다.
     printUsageOnConsole();
 
+    // 화면 내보내기 시작
+    if (pFrameExportName)
+    {
+        initFrameExport(pFrameExportName, fbvar);
+    }
+
+    // 입력 기록 또는 재생 시작
+    initInputTrace(inputTraceMode, pInputTraceFileName, isReplayMaxSpeed);
+
+    // 연속 재생 모드는 입력을 받지 않고 재생이 끝나면(또는 Ctrl + c) 종료한다.
+    if (pPlaybackPattern)
+    {
+        playImageSequence(pfbmap, fbvar, pPlaybackPattern, playbackFramesPerSecond, playbackLoopCount, jobCount, playbackMemoryBudget, &colorLUT);
+        quit = 1;
+    }
+
+    // 화면을 바꾼 명령을 처리했는지 여부. 처음에는 시작 화면을 내보내도록 true로 둔다.
+    bool isFrameDirty = true;
+
     while (!quit)
     {
+        // 초가 바뀌었다면 시계 영역만 다시 그린다.
+        if (isClockDisplayed && updateClockOverlay(clockTextIndex))
+        {
+            compositeOverlayLayers(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, &colorLUT, &viewport);
+            isFrameDirty = true;
+        }
+
+        // 직전 명령이 화면을 바꿨다면 결과 화면을 내보낸다. 입력이 없었던 폴링이나 화면과 무관한 명령은 내보내지 않는다.
+        if (isFrameDirty)
+        {
+            publishFrame(pfbmap);
+            isFrameDirty = false;
+        }
+
+        // 재생 중이라면 직전 입력의 처리가 끝났으므로 처리 시간을 출력한다.
+        finishReplayEvent();
+
+        // 재생 중이라면 기록 파일에서 입력을 받고, 기록이 끝나면 종료한다.
         // 장치가 연결되어 있다면 Push Switch 입력을 받고 인덱스에 1을 더해준다. (0~8 -> 1~9)
         int pushSwitchValue = 0;
-        if (isDeviceConnected)
+        if (isInputReplaying())
+        {
+            pushSwitchValue = readReplayEvent();
+            if (pushSwitchValue < 0)
+            {
+                break;
+            }
+        }
+        else if (isDeviceConnected)
         {
             read(fdPushSwitch, &pushSwitchBuffer, PUSH_SWITCH_BUFFER_SIZE);
             for (pushSwitchIndex=0; pushSwitchIndex < PUSH_SWITCH_BUFFER_SIZE; pushSwitchIndex++)
@@ -157,99 +659,167 @@ int main(int argc, char* argv[])
                 }
             }
         }
-        // 장치가 없으면 콘솔에서 숫자로 입력받는다.
+        // 장치가 없으면 콘솔에서 숫자(또는 w/a/s/d, +/-)로 입력받는다.
         else
         {
-            scanf("%d", &pushSwitchValue);
-            while ( getchar() != '\n' );
+            // 시계를 표시한다면 다음 초까지만 기다리고, 입력이 없었으면 시계를 갱신하러 돌아간다.
+            if (isClockDisplayed && !waitConsoleInputUntilNextSecond())
+            {
+                continue;
+            }
+            pushSwitchValue = readConsoleCommand();
+        }
+
+        // 이동 모드 변환 전의 입력을 기록해야 재생할 때도 같은 변환을 거친다.
+        recordInputEvent(pushSwitchValue);
+
+        // 이동 모드에서는 2, 4, 6, 8번 버튼이 방향키가 된다.
+        if (isPanMode)
+        {
+            pushSwitchValue = translatePanModeCommand(pushSwitchValue);
         }
 
         // 시간을 측정한다.
         clock_t timeStart = clock();
+
+        // 미리 변환한 파일을 출력한 상태에서 이미지가 필요한 기능(4~8번, 이동, 레이어)을 사용하면 원본을 읽어온다.
+        if (isPrerenderDisplayed && pushSwitchValue >= 4 && pushSwitchValue != 9)
+        {
+            beginProfile(&profileSample);
+            loadBitmapImage(pfbmap, fbvar, &pBitmapHeader, &pBitmapPixel2dArray, pFileNameArray[fileIndex]);
+            endProfile(&profileSample, "load", (long long)pBitmapHeader->biWidth * pBitmapHeader->biHeight);
+            isPrerenderDisplayed = false;
+        }
         
         switch (pushSwitchValue)
         {
-            // 다음 이미지 열기
+            // 다음(1), 이전(2) 이미지 열기
             case 1:
-                clearFrameBuffer(pfbmap, fbvar);
-                brightness = 0;
-
-                // 다음 파일이 있는지 체크
-                fileIndex = thresholding(fileIndex + 1, 0, FILE_NAME_ARRAY_SIZE - 1);
+            case 2:
+            {
+                clearFrameBufferUnderOverlays(pfbmap, fbvar, &colorLUT, &viewport);
+                isFrameDirty = true;
+                colorAdjustment.brightness = 0;
+                buildColorLUT(&colorLUT, &colorAdjustment);
+                initViewport(&viewport);
+
+                // 다음 또는 이전 파일이 있는지 체크
+                const int fileIndexDelta = (pushSwitchValue == 1) ? 1 : -1;
+                fileIndex = thresholding(fileIndex + fileIndexDelta, 0, FILE_NAME_ARRAY_SIZE - 1);
                 if (!pFileNameArray[fileIndex])
                 {
-                    printf("There isn't next file, index:%d\n", fileIndex); 
-                    fileIndex--;    
+                    printf("There isn't %s file, index:%d\n", (pushSwitchValue == 1) ? "next" : "previous", fileIndex);
+                    fileIndex -= fileIndexDelta;
                     break;
                 }
 
-                // 다음 파일이 있다면 이미지 읽어오기
-                loadBitmapImage(pfbmap, fbvar, &pBitmapHeader, &pBitmapPixel2dArray, pFileNameArray[fileIndex]);
+                // 이전에 읽어온 이미지 해제
+                freeBitmapImage(pBitmapHeader, pBitmapPixel2dArray);
+                pBitmapHeader = NULL;
+                pBitmapPixel2dArray = NULL;
 
-                // 프레임 버퍼에 이미지 출력
-                drawImageOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, brightness);
+                // 캡처 파일을 열 수도 있으므로 진행중인 쓰기가 끝나기를 기다린다.
+                drainAsyncIO();
+
+                // 목록을 만든 뒤 읽을 수 없게 바뀐 파일은 열지 않는다.
+                const ImageCatalogEntry *pCatalogEntry = getImageCatalogEntry(pFileNameArray[fileIndex]);
+                if (!pCatalogEntry || !pCatalogEntry->isValid)
+                {
+                    printf("Invalid bitmap file - %s\n", pFileNameArray[fileIndex]);
+                    isPrerenderDisplayed = false;
+                    break;
+                }
+                const int imageWidth = pCatalogEntry->width;
+                const int imageHeight = pCatalogEntry->height;
+                const int imageBitCount = pCatalogEntry->bitCount;
 
-                // Text LCD를 통해 헤더 정보(파일명, 해상도, BPP) 출력
+                // 메타데이터 목록의 헤더 정보(파일명, 해상도, BPP)를 이미지를 읽기 전에 Text LCD로 출력한다.
                 memcpy(textLCDBuffer[0], pFileNameArray[fileIndex], TEXT_LCD_BUFFER_SIZE);
-                sprintf(textLCDBuffer[1], "%d*%d BPP:%d", pBitmapHeader->biWidth, pBitmapHeader->biHeight, pBitmapHeader->biBitCount);
-                printf("Text LCD : [%s] / [%s]\n", textLCDBuffer[0], textLCDBuffer[1]);
-                
+                // 해상도가 큰 경우 16글자를 꽉 채우므로 문자열 끝의 NULL이 배열 밖에 쓰이지 않도록 따로 만든 뒤 복사한다.
+                char resolutionText[TEXT_LCD_BUFFER_SIZE];
+                snprintf(resolutionText, sizeof(resolutionText), "%d*%d BPP:%d", imageWidth, imageHeight, imageBitCount);
+                strncpy((char *)textLCDBuffer[1], resolutionText, TEXT_LCD_WIDTH);
                 if (isDeviceConnected)
                 {
                     lseek(fdTextLcd, 0, SEEK_SET);
                     write(fdTextLcd, textLCDBuffer, TEXT_LCD_BUFFER_SIZE);
                 }
-                break;
 
-            // 이전 이미지 열기
-            case 2:
-                clearFrameBuffer(pfbmap, fbvar);
-                brightness = 0;
+                // 화면에도 표시한다. 이미지를 그릴 때 글자 영역도 함께 그려진다.
+                if (isInfoDisplayed)
+                {
+                    setTextOverlay(infoTextIndexArray[0], pFileNameArray[fileIndex]);
+                    sprintf(infoText, "%d*%d BPP:%d x%d/%d", imageWidth, imageHeight, imageBitCount, viewport.zoomIn, viewport.zoomOut);
+                    setTextOverlay(infoTextIndexArray[1], infoText);
+                }
 
-                // 이전 파일이 있는지 체크
-                fileIndex = thresholding(fileIndex - 1, 0, FILE_NAME_ARRAY_SIZE - 1);
-                if (!pFileNameArray[fileIndex])
+                // 색상 조정이 없다면 미리 변환한 파일을 변환 없이 그대로 복사한다.
+                // 이 경우 원본 이미지는 이미지가 필요한 기능을 처음 사용할 때 읽어온다.
+                // 자동 레벨은 원본의 히스토그램이 필요하므로 미리 변환한 파일을 사용하지 않는다.
+                // 레이어가 보이는 동안에도 레이어 아래를 다시 그릴 원본이 필요하므로 사용하지 않는다.
+                beginProfile(&profileSample);
+
+                PrerenderHeader prerenderHeader;
+                isPrerenderDisplayed = !isAutoLevels
+                    && !hasVisibleOverlayLayer()
+                    && isColorAdjustmentIdentity(&colorAdjustment)
+                    && displayPrerenderedImage(pfbmap, fbvar, pFileNameArray[fileIndex], &prerenderHeader);
+
+                if (isAutoLevels)
                 {
-                    printf("There isn't previous file, index:%d\n", fileIndex);    
-                    fileIndex++;
-                    break;
+                    // 읽으면서 히스토그램을 세고, 레벨을 정한 뒤 한 번만 출력한다.
+                    loadBitmapImageProgressive(pfbmap, fbvar, &pBitmapHeader, &pBitmapPixel2dArray, pFileNameArray[fileIndex], NULL, &viewport, &colorHistogram);
+                    deriveAutoLevels(&colorAdjustment, &colorHistogram);
+                    buildColorLUT(&colorLUT, &colorAdjustment);
+                    drawImageOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, &colorLUT, &viewport);
+
+                    printf("Auto levels : B %d:%d / G %d:%d / R %d:%d\n",
+                        colorAdjustment.levelsLow[COLOR_CHANNEL_BLUE], colorAdjustment.levelsHigh[COLOR_CHANNEL_BLUE],
+                        colorAdjustment.levelsLow[COLOR_CHANNEL_GREEN], colorAdjustment.levelsHigh[COLOR_CHANNEL_GREEN],
+                        colorAdjustment.levelsLow[COLOR_CHANNEL_RED], colorAdjustment.levelsHigh[COLOR_CHANNEL_RED]);
                 }
-                
-                // 이전 파일이 있다면 이미지 읽어오기
-                loadBitmapImage(pfbmap, fbvar, &pBitmapHeader, &pBitmapPixel2dArray, pFileNameArray[fileIndex]);
+                else if (!isPrerenderDisplayed)
+                {
+                    // 파일이 있다면 이미지를 읽어오면서 다 읽은 부분부터 프레임 버퍼에 출력
+                    loadBitmapImageProgressive(pfbmap, fbvar, &pBitmapHeader, &pBitmapPixel2dArray, pFileNameArray[fileIndex], &colorLUT, &viewport, NULL);
 
-                // 프레임 버퍼에 이미지 출력
-                drawImageOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, brightness);
+                    // 이미지 행만 그려지므로 이미지 밖에 걸친 레이어는 다시 그린다.
+                    invalidateOverlayLayers();
+                    compositeOverlayLayers(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, &colorLUT, &viewport);
+                }
 
-                // Text LCD를 통해 헤더 정보(파일명, 해상도, BPP) 출력
-                memcpy(textLCDBuffer[0], pFileNameArray[fileIndex], TEXT_LCD_BUFFER_SIZE);
-                sprintf(textLCDBuffer[1], "%d*%d BPP:%d", pBitmapHeader->biWidth, pBitmapHeader->biHeight, pBitmapHeader->biBitCount);
-                printf("Text LCD : [%s] / [%s]\n", textLCDBuffer[0], textLCDBuffer[1]);
-                
-                if (isDeviceConnected)
+                // 이미지를 읽으면서 출력하므로 읽기와 출력을 합쳐서 측정한다.
+                endProfile(&profileSample, isPrerenderDisplayed ? "load (prerendered)" : "load", (long long)imageWidth * imageHeight);
+
+                // 같은 방향으로 이어서 열 파일들을 페이지 캐시로 미리 읽어둔다.
+                for (int prefetchIndex = 1; prefetchIndex <= PREFETCH_FILE_COUNT; prefetchIndex++)
                 {
-                    lseek(fdTextLcd, 0, SEEK_SET);
-                    write(fdTextLcd, textLCDBuffer, TEXT_LCD_BUFFER_SIZE);
+                    const int prefetchFileIndex = fileIndex + fileIndexDelta * prefetchIndex;
+                    if (prefetchFileIndex < 0 || prefetchFileIndex >= FILE_NAME_ARRAY_SIZE || !pFileNameArray[prefetchFileIndex])
+                    {
+                        break;
+                    }
+                    prefetchImageFile(pFileNameArray[prefetchFileIndex]);
                 }
+
+                printf("Text LCD : [%.*s] / [%.*s]%s\n", TEXT_LCD_WIDTH, textLCDBuffer[0], TEXT_LCD_WIDTH, textLCDBuffer[1], isPrerenderDisplayed ? " (prerendered)" : "");
                 break;
+            }
 
             // 프레임 버퍼 비우기
             case 3:
-                if (isImageLoaded(pBitmapHeader, pBitmapPixel2dArray))
-                {
-                    free(pBitmapHeader);
-                    
-                    for (int rowIndex = pBitmapHeader->biHeight-1; rowIndex >= 0; rowIndex--)
-                    {
-                        free(pBitmapPixel2dArray[rowIndex]);
-                    }
-                    free(pBitmapPixel2dArray);
+                freeBitmapImage(pBitmapHeader, pBitmapPixel2dArray);
+                pBitmapHeader = NULL;
+                pBitmapPixel2dArray = NULL;
+                isPrerenderDisplayed = false;
 
-                    pBitmapHeader = NULL;
-                    pBitmapPixel2dArray = NULL;
+                if (isInfoDisplayed)
+                {
+                    setTextOverlay(infoTextIndexArray[0], "");
+                    setTextOverlay(infoTextIndexArray[1], "");
                 }
-
-                clearFrameBuffer(pfbmap, fbvar);
+                clearFrameBufferUnderOverlays(pfbmap, fbvar, &colorLUT, &viewport);
+                isFrameDirty = true;
                 break;
 
             // 프레임 버퍼 밝기 증가
@@ -257,16 +827,21 @@ int main(int argc, char* argv[])
                 // 읽어온 이미지가 있어야 동작 가능하다.
                 if (!isImageLoaded(pBitmapHeader, pBitmapPixel2dArray))
                 {
-                    clearFrameBuffer(pfbmap, fbvar);
+                    clearFrameBufferUnderOverlays(pfbmap, fbvar, &colorLUT, &viewport);
+                    isFrameDirty = true;
                     printf("There isn't any loaded image.\n");
                     break;
                 }
 
                 // 밝기 조절
-                brightness = thresholding(brightness + BRIGHTNESS_DELTA, -UCHAR_MAX, UCHAR_MAX);
+                colorAdjustment.brightness = thresholding(colorAdjustment.brightness + BRIGHTNESS_DELTA, -UCHAR_MAX, UCHAR_MAX);
+                buildColorLUT(&colorLUT, &colorAdjustment);
 
                 // 프레임 버퍼에 이미지 출력
-                drawImageOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, brightness);
+                beginProfile(&profileSample);
+                drawImageOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, &colorLUT, &viewport);
+                endProfile(&profileSample, "draw", screenPixelCount);
+                isFrameDirty = true;
 
                 // 밝기를 변경시킨 경우 break 대신 continue를 사용하여 콘솔 메시지 출력을 건너뛴다.
                 continue;
@@ -276,16 +851,21 @@ int main(int argc, char* argv[])
                 // 읽어온 이미지가 있어야 동작 가능하다.
                 if (!isImageLoaded(pBitmapHeader, pBitmapPixel2dArray))
                 {
-                    clearFrameBuffer(pfbmap, fbvar);
+                    clearFrameBufferUnderOverlays(pfbmap, fbvar, &colorLUT, &viewport);
+                    isFrameDirty = true;
                     printf("There isn't any loaded image.\n");
                     break;
                 }
 
                 // 밝기 조절
-                brightness = thresholding(brightness - BRIGHTNESS_DELTA, -UCHAR_MAX, UCHAR_MAX);
+                colorAdjustment.brightness = thresholding(colorAdjustment.brightness - BRIGHTNESS_DELTA, -UCHAR_MAX, UCHAR_MAX);
+                buildColorLUT(&colorLUT, &colorAdjustment);
                 
                 // 프레임 버퍼에 이미지 출력
-                drawImageOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, brightness);
+                beginProfile(&profileSample);
+                drawImageOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, &colorLUT, &viewport);
+                endProfile(&profileSample, "draw", screenPixelCount);
+                isFrameDirty = true;
                 
                 // 밝기를 변경시킨 경우 break 대신 continue를 사용하여 콘솔 메시지 출력을 건너뛴다.
                 continue;
@@ -295,16 +875,90 @@ int main(int argc, char* argv[])
                 // 읽어온 이미지가 있어야 동작 가능하다.
                 if (!isImageLoaded(pBitmapHeader, pBitmapPixel2dArray))
                 {
-                    clearFrameBuffer(pfbmap, fbvar);
+                    clearFrameBufferUnderOverlays(pfbmap, fbvar, &colorLUT, &viewport);
+                    isFrameDirty = true;
                     printf("There isn't any loaded image.\n");
                     break;
                 }
 
-                // 프레임 버퍼 캡처
+                // 프레임 버퍼 캡처 (파일 쓰기는 비동기이므로 변환까지만 측정된다.)
+                beginProfile(&profileSample);
                 captureFrameBuffer(pfbmap, fbvar, pBitmapHeader);
+                endProfile(&profileSample, "capture",
+                    (long long)MIN(getScreenWidth(fbvar), pBitmapHeader->biWidth) * MIN(getScreenHeight(fbvar), pBitmapHeader->biHeight));
 
                 // 새 파일이 추가되었으므로 파일 목록을 다시 불러온다.
+                // 메타데이터 목록에 다 쓴 파일이 들어가도록 쓰기가 끝나기를 기다린다.
+                drainAsyncIO();
                 searchFilesInPathByExtention(pFileNameArray, ".", BITMAP_EXTENSION);
+                updateImageCatalog(pFileNameArray);
+                selectCatalogImageFiles(pFileNameArray, imageSortKey, minimumImageWidth, minimumImageHeight, minimumModifiedTime);
+                break;
+
+            // 확대, 축소
+            case 7:
+            case 8:
+                // 읽어온 이미지가 있어야 동작 가능하다.
+                if (!isImageLoaded(pBitmapHeader, pBitmapPixel2dArray))
+                {
+                    clearFrameBufferUnderOverlays(pfbmap, fbvar, &colorLUT, &viewport);
+                    isFrameDirty = true;
+                    printf("There isn't any loaded image.\n");
+                    break;
+                }
+
+                zoomViewport(&viewport, fbvar, pBitmapHeader, (pushSwitchValue == 7) ? ZOOM_IN : ZOOM_OUT);
+
+                // 전체를 다시 그리므로 배율 표시는 그리기 전에 바꾼다.
+                if (isInfoDisplayed)
+                {
+                    sprintf(infoText, "%d*%d BPP:%d x%d/%d", pBitmapHeader->biWidth, pBitmapHeader->biHeight, pBitmapHeader->biBitCount, viewport.zoomIn, viewport.zoomOut);
+                    setTextOverlay(infoTextIndexArray[1], infoText);
+                }
+
+                // 프레임 버퍼에 이미지 출력
+                beginProfile(&profileSample);
+                drawImageOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, &colorLUT, &viewport);
+                endProfile(&profileSample, "draw", screenPixelCount);
+                isFrameDirty = true;
+                printf("Zoom : x%d/%d\n", viewport.zoomIn, viewport.zoomOut);
+                break;
+
+            // 이동 모드 켜고 끄기
+            case 9:
+                isPanMode = !isPanMode;
+                printf("Pan mode : %s\n", isPanMode ? "on" : "off");
+                break;
+
+            // 이동
+            case COMMAND_PAN_UP:
+            case COMMAND_PAN_DOWN:
+            case COMMAND_PAN_LEFT:
+            case COMMAND_PAN_RIGHT:
+                // 읽어온 이미지가 있어야 동작 가능하다.
+                if (!isImageLoaded(pBitmapHeader, pBitmapPixel2dArray))
+                {
+                    clearFrameBufferUnderOverlays(pfbmap, fbvar, &colorLUT, &viewport);
+                    isFrameDirty = true;
+                    printf("There isn't any loaded image.\n");
+                    break;
+                }
+
+                // 새로 드러난 부분만 다시 그린다.
+                panImageOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, &colorLUT, &viewport, pushSwitchValue);
+                isFrameDirty = true;
+                break;
+
+            // 레이어 보이기, 숨기기 (레이어 영역만 다시 그린다.)
+            case COMMAND_TOGGLE_OVERLAY:
+                isOverlayVisible = !isOverlayVisible;
+                for (int layerIndex = 0; layerIndex < getOverlayLayerCount(); layerIndex++)
+                {
+                    setOverlayLayerVisible(layerIndex, isOverlayVisible);
+                }
+                compositeOverlayLayers(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, &colorLUT, &viewport);
+                isFrameDirty = true;
+                printf("Overlay : %s\n", isOverlayVisible ? "on" : "off");
                 break;
 
             default:
@@ -317,7 +971,7 @@ int main(int argc, char* argv[])
         clock_t timeEnd = clock();
 
         // 오래 걸리는 기능을 실행했을 경우에만 시간을 출력한다.
-        if (pushSwitchValue == 1 || pushSwitchValue == 2 || pushSwitchValue == 6)
+        if (pushSwitchValue == 1 || pushSwitchValue == 2 || pushSwitchValue == 6 || pushSwitchValue == 7 || pushSwitchValue == 8 || pushSwitchValue >= COMMAND_PAN_UP)
         {
             printf("TIME : %f\n", ((double)(timeEnd - timeStart)/1000000));
         }
@@ -328,8 +982,24 @@ int main(int argc, char* argv[])
         printUsageOnConsole();
     }
 
+    // 진행중인 파일 쓰기를 마치고 비동기 I/O 엔진을 멈춘다.
+    closeAsyncIO();
+    closeProfiler();
+
+    // 기록한 세션과 재생 결과를 비교할 수 있도록 마지막 화면의 체크섬을 출력한다.
+    if (inputTraceMode != INPUT_TRACE_NONE)
+    {
+        printf("Frame buffer checksum : %016llx\n", calculateFrameBufferChecksum(pfbmap, fbvar));
+    }
+    closeInputTrace();
+    closeFrameExport();
+    closeImageCatalog();
+
     // 장치 드라이버 닫기
-    close(fdFrameBuffer);
+    if (fdFrameBuffer >= 0)
+    {
+        close(fdFrameBuffer);
+    }
     if (isDeviceConnected)
     {
         close(fdTextLcd);
@@ -340,16 +1010,9 @@ int main(int argc, char* argv[])
     munmap(pfbmap, calculateFrameBufferSize(fbvar));
 
     // 동적 할당된 메모리 해제
-    if (isImageLoaded(pBitmapHeader, pBitmapPixel2dArray))
-    {
-        free(pBitmapHeader);
-
-        for (int rowIndex = pBitmapHeader->biHeight-1; rowIndex >= 0; rowIndex--)
-        {
-            free(pBitmapPixel2dArray[rowIndex]);
-        }
-        free(pBitmapPixel2dArray);
-    }
+    freeBitmapImage(pBitmapHeader, pBitmapPixel2dArray);
+    printBufferPoolStatistics();
+    closeBufferPool();
 
     for (int fileNameArrayIndex = 0; fileNameArrayIndex < FILE_NAME_ARRAY_SIZE; fileNameArrayIndex++)
     {
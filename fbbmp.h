@@ -10,6 +10,7 @@
 
 #define OUTPUT_BITMAP_FILE_NAME "output.bmp"
 #define BITMAP_EXTENSION "bmp"
+#define PRERENDER_EXTENSION "fbraw"     // 프레임 버퍼 형식으로 미리 변환한 파일의 확장자
 
 #define PUSH_SWITCH_BUFFER_SIZE 9       // Push Switch의 버튼 갯수는 9개다.
 #define TEXT_LCD_HEIGHT 2               // Text LCD는 2개의 행을 가진다.
@@ -18,10 +19,14 @@
 
 #define FILE_NAME_ARRAY_SIZE 64         // 비트맵 파일 이름을 64개 까지만 저장할 것이다.
 #define FILE_NAME_MAX_LENGTH 255        // 비트맵 파일 이름 최대 길이
+#define FILE_PATH_MAX_LENGTH 4096       // 디렉토리를 포함한 파일 경로 최대 길이
 
 #define BITMAP_HEADER_SIZE 54           // 비트맵 헤더의 크기는 54로 고정되어 있다.
 #define BITMAP_DEFAULT_BPP 24           // 비트맵 파일의 기본 BPP는 24이다.
 
+#define PRERENDER_MAGIC 0x57524246     // 미리 변환한 파일의 매직 넘버 ("FBRW")
+#define PRERENDER_VERSION 3             // 미리 변환한 파일 헤더의 버전
+
 #define BPP_16 16                       // 16 BPP (Bits Per Pixel)
 #define BPP_24 24                       // 24 BPP (Bits Per Pixel)
 #define BPP_32 32                       // 32 BPP (Bits Per Pixel)
@@ -30,10 +35,113 @@
 #define UCHAR_MAX 255                   // unsigned char 최댓값
 
 #define BRIGHTNESS_DELTA 30             // 변화시킬 프레임 버퍼 밝기
+#define CONTRAST_DEFAULT 100            // 대비 기본값 (100%는 원본과 동일)
+#define GAMMA_DEFAULT 1.0               // 감마 기본값 (1.0은 원본과 동일)
+
+#define COLOR_CHANNEL_COUNT 3           // 색상 채널 수 (RGBpixel과 같은 B, G, R 순서)
+#define COLOR_CHANNEL_BLUE 0
+#define COLOR_CHANNEL_GREEN 1
+#define COLOR_CHANNEL_RED 2
+#define COLOR_LUT_SIZE 256              // 채널당 색상 변환 테이블 크기 (8비트 입력)
+#define HISTOGRAM_COPY_COUNT 4          // 히스토그램을 나눠 세는 사본 수 (같은 칸을 연달아 갱신하는 지연을 줄인다.)
+#define AUTO_LEVELS_CLIP_PERMILLE 5     // 자동 레벨에서 양 끝에서 잘라낼 픽셀 비율 (천분율)
+
+#define ROTATION_0 0                    // 화면 회전 각도 (시계 방향)
+#define ROTATION_90 90
+#define ROTATION_180 180
+#define ROTATION_270 270
+#define ROTATION_BAND_HEIGHT 128        // 90, 270도 회전 시 한 번에 전치하는 띠의 크기 (프레임 버퍼 한 행에 연속으로 쓰는 픽셀 수)
+#define ROTATION_TILE_SIZE 16           // 90, 270도 회전 시 전치 블록의 가로, 세로 크기 (픽셀, 32BPP에서 한 행이 캐시 라인 하나)
+
+#define DITHER_NONE 0                   // 16BPP 변환 시 하위 비트를 버린다.
+#define DITHER_BAYER_4 4                // 16BPP 변환 시 4x4 Bayer 행렬로 순서 디더링한다.
+#define DITHER_BAYER_8 8                // 16BPP 변환 시 8x8 Bayer 행렬로 순서 디더링한다.
+#define DITHER_MATRIX_MAX 8             // Bayer 행렬의 최대 크기
+#define DITHER_BIAS_COUNT 8             // 16BPP 순서 디더링의 보정값 수 (5비트 채널은 0~7, 6비트 채널은 그 절반을 더한다.)
+
+#define PROGRESSIVE_RING_SIZE 4         // 읽기 단계와 출력 단계를 잇는 링 버퍼의 칸 수
+#define PROGRESSIVE_BAND_BYTES 65536    // 링 버퍼 한 칸의 크기 (한 번에 읽는 바이트 수)
+
+#define ASYNC_IO_QUEUE_DEPTH 32         // 동시에 진행할 수 있는 비동기 I/O 요청 수
+#define ASYNC_IO_WORKER_COUNT 4         // io_uring을 사용할 수 없을 때 대신 사용할 작업 스레드 수
+#define ASYNC_IO_PROBE_OP_COUNT 256     // io_uring 요청 종류 지원 여부를 조회할 때 받을 항목 수 (opcode는 8비트)
+#define ASYNC_IO_READ 0                 // 비동기 I/O 요청 종류 : 읽기
+#define ASYNC_IO_WRITE 1                // 비동기 I/O 요청 종류 : 쓰기
+#define ASYNC_IO_READAHEAD 2            // 비동기 I/O 요청 종류 : 페이지 캐시로 미리 읽기
+#define ASYNC_IO_ENGINE_SYNC 0          // 비동기 I/O 엔진 : 제출한 자리에서 바로 실행
+#define ASYNC_IO_ENGINE_THREAD_POOL 1   // 비동기 I/O 엔진 : 작업 스레드
+#define ASYNC_IO_ENGINE_IO_URING 2      // 비동기 I/O 엔진 : io_uring (리눅스 5.6 이상)
+#define PREFETCH_FILE_COUNT 2           // 이미지를 열 때 진행 방향으로 미리 읽어둘 파일 수
+
+#define PLAYBACK_DEFAULT_FPS 30         // 연속 재생의 기본 초당 프레임 수
+#define PLAYBACK_DEFAULT_MEMORY_MB 64   // 연속 재생에 사용할 프레임 메모리 기본 한도 (MB)
+#define PLAYBACK_QUEUE_DEPTH 8          // 모든 프레임을 담아둘 수 없을 때 미리 디코딩해둘 최대 프레임 수
+#define PLAYBACK_REPORT_INTERVAL 1000000000LL   // 연속 재생 통계를 출력하는 간격 (나노초)
+
+#define BUFFER_POOL_DEFAULT_MEMORY_MB 256    // 버퍼 풀이 매핑해둘 수 있는 메모리 기본 한도 (MB)
+#define BUFFER_POOL_HEADER_SIZE 64      // 버퍼 풀 블록 헤더 크기 (버퍼가 캐시 라인 경계에서 시작하도록 한다.)
+#define BUFFER_POOL_SIZE_GRANULE 65536  // 버퍼 풀 블록 크기의 단위 (비슷한 크기의 요청이 블록을 다시 쓸 수 있게 한다.)
+#define BUFFER_POOL_HUGE_PAGE_SIZE (2 << 20)    // 큰 페이지 크기. 이보다 큰 블록만 큰 페이지로 매핑한다.
+
+#define PROFILE_COUNTER_COUNT 5         // --profile에서 측정하는 성능 카운터 수
+#define PROFILE_COUNTER_CYCLES 0
+#define PROFILE_COUNTER_INSTRUCTIONS 1
+#define PROFILE_COUNTER_CACHE_MISSES 2
+#define PROFILE_COUNTER_BRANCH_MISSES 3
+#define PROFILE_COUNTER_PAGE_FAULTS 4
+#define PROFILE_COUNTER_NAME_LENGTH 32  // 출력할 카운터 이름(사용자 영역만 세면 :u를 붙인다.)의 최대 길이
+
+#define INPUT_TRACE_NONE 0              // 입력 기록, 재생을 하지 않는다.
+#define INPUT_TRACE_RECORD 1            // 입력을 시각과 함께 파일에 기록한다.
+#define INPUT_TRACE_REPLAY 2            // 기록한 입력을 파일에서 읽어 재생한다.
+
+#define FRAME_EXPORT_MAGIC 0x58454246  // 프레임 내보내기 공유 메모리의 매직 넘버 ("FBEX")
+#define FRAME_EXPORT_VERSION 1          // 프레임 내보내기 헤더의 버전
+#define FRAME_EXPORT_SLOT_COUNT 3       // 프레임 내보내기 링의 칸 수
+#define FRAME_EXPORT_DEFAULT_NAME "/fbbmp"  // 프레임 내보내기 공유 메모리의 기본 이름
+
+#define IMAGE_CATALOG_FILE_NAME ".fbbmp.catalog"    // 이미지와 같은 디렉토리에 저장하는 메타데이터 목록 파일
+#define IMAGE_CATALOG_MAGIC 0x54434246  // 메타데이터 목록 파일의 매직 넘버 ("FBCT")
+#define IMAGE_CATALOG_VERSION 1         // 메타데이터 목록 파일의 버전
+#define IMAGE_SORT_NONE 0               // 파일 목록 정렬 기준 (디렉토리 순서)
+#define IMAGE_SORT_NAME 1               // 파일명
+#define IMAGE_SORT_RESOLUTION 2         // 해상도 (픽셀 수)
+#define IMAGE_SORT_DATE 3               // 수정 시각
+
+#define ZOOM_IN 1                       // 확대
+#define ZOOM_OUT -1                     // 축소
+#define PAN_STEP_DIVISOR 8              // 한 번 이동할 때 화면 크기의 1/8만큼 이동한다.
+
+#define COMMAND_PAN_UP 10               // 버튼이 없는 이동 명령 (이동 모드의 2, 8, 4, 6번 버튼 또는 콘솔의 w, s, a, d)
+#define COMMAND_PAN_DOWN 11
+#define COMMAND_PAN_LEFT 12
+#define COMMAND_PAN_RIGHT 13
+#define COMMAND_TOGGLE_OVERLAY 14       // 버튼이 없는 레이어 보이기/숨기기 명령 (콘솔의 o)
+
+#define OVERLAY_LAYER_MAX 16            // 이미지 위에 겹쳐 그릴 수 있는 레이어 수
+#define OVERLAY_BITMAP_BPP 32           // 레이어 비트맵 파일의 BPP (B, G, R, A)
+#define BITMAP_COMPRESSION_RGB 0       // 비트맵 압축 방식 : 압축 없음
+#define BITMAP_COMPRESSION_BITFIELDS 3  // 비트맵 압축 방식 : 압축 없이 채널별 비트 마스크 지정 (헤더 바로 뒤에 R, G, B(, A) 순서)
+#define BITMAP_ALPHA_MASK_HEADER_SIZE 56    // 알파 마스크까지 포함하는 정보 헤더의 최소 크기 (BITMAPV3INFOHEADER 이상)
+
+#define FONT_FIRST_CHARACTER ' '        // 내장 글꼴은 ASCII 32~126의 5x7 비트맵이다.
+#define FONT_LAST_CHARACTER '~'
+#define FONT_GLYPH_WIDTH 5
+#define FONT_GLYPH_HEIGHT 7
+#define TEXT_CELL_WIDTH 6               // 글자 한 칸의 크기 (왼쪽 1픽셀, 위아래 1픽셀 여백 포함)
+#define TEXT_CELL_HEIGHT 9
+#define TEXT_OVERLAY_SCALE 2            // 글꼴 확대 배율
+#define TEXT_OVERLAY_MAX 4              // 글자 레이어 수
+#define TEXT_OVERLAY_MAX_COLUMN 64      // 글자 레이어 한 줄의 최대 글자 수
+#define TEXT_OVERLAY_BACKGROUND_ALPHA 160   // 글자 뒤 검은 배경의 불투명도 (0~255)
+#define TEXT_INFO_MARGIN 4              // 화면 정보(--info)와 화면 가장자리 사이 간격
+#define CLOCK_TEXT_COLUMN_COUNT 8       // 시계(--clock)의 글자 수 (HH:MM:SS)
 
 extern unsigned char quit;              // 무한 반복문 종료를 위한 변수
 extern int frameBufferBPP;              // 프레임 버퍼의 BPP를 설정하기 위한 변수
 extern bool isDeviceConnected;          // 장치가 연결되어 있는지 확인하기 위한 변수
+extern int displayRotation;             // 화면 회전 각도 (0, 90, 180, 270)
+extern int ditherMatrixSize;            // 16BPP 순서 디더링의 Bayer 행렬 크기 (DITHER_NONE이면 디더링하지 않는다.)
 
 typedef struct pixel_24bit
 {
@@ -42,6 +150,156 @@ typedef struct pixel_24bit
     unsigned char red;
 } RGBpixel;
 
+// 픽셀에 적용할 색상 조정 값. 모든 조정은 하나의 색상 변환 테이블로 합쳐진다.
+typedef struct colorAdjustment
+{
+    int brightness;                                 // 밝기 (-255 ~ 255)
+    int contrast;                                   // 대비 (백분율, 100 = 원본)
+    double gamma;                                   // 감마 (1.0 = 원본, 클수록 밝아진다)
+    unsigned char levelsLow[COLOR_CHANNEL_COUNT];   // 채널별 입력 레벨 하한 (이 값 이하는 0이 된다)
+    unsigned char levelsHigh[COLOR_CHANNEL_COUNT];  // 채널별 입력 레벨 상한 (이 값 이상은 255가 된다)
+} ColorAdjustment;
+
+// 채널별 8비트 값을 색상 조정과 프레임 버퍼 픽셀 형식 변환까지 마친 값으로 바꾸는 테이블
+// 세 채널의 값을 OR 하면 프레임 버퍼에 그대로 쓸 수 있는 픽셀이 된다.
+typedef struct colorLookupTable
+{
+    unsigned int blue[COLOR_LUT_SIZE];
+    unsigned int green[COLOR_LUT_SIZE];
+    unsigned int red[COLOR_LUT_SIZE];
+    unsigned short dither[DITHER_BIAS_COUNT][COLOR_CHANNEL_COUNT][COLOR_LUT_SIZE];  // 16BPP 순서 디더링의 보정값별 테이블 (보정값을 더하고 하위 비트를 버린 값)
+} ColorLUT;
+
+// 채널별 8비트 값의 히스토그램. 픽셀마다 돌아가며 다른 사본에 세고 사용할 때 합친다.
+typedef struct colorHistogram
+{
+    unsigned int count[HISTOGRAM_COPY_COUNT][COLOR_CHANNEL_COUNT][COLOR_LUT_SIZE];
+} ColorHistogram;
+
+// 화면에 보이는 이미지 영역. 확대, 축소 배율은 정수이고 둘 중 하나는 항상 1이다.
+typedef struct viewport
+{
+    int zoomIn;                     // 확대 배율 (이미지 픽셀 하나를 zoomIn * zoomIn 화면 픽셀로 복제)
+    int zoomOut;                    // 축소 배율 (이미지 픽셀을 zoomOut 간격으로 건너뛰며 출력)
+    int originX;                    // 화면 좌상단에 대응하는 이미지의 x 좌표
+    int originY;                    // 화면 좌상단에 대응하는 이미지의 y 좌표
+} Viewport;
+
+// 다시 그려야 하는 화면 영역 (화면 회전 전 좌표)
+typedef struct dirtyRect
+{
+    int x;
+    int y;
+    int width;                      // 0이면 다시 그릴 영역이 없다.
+    int height;
+} DirtyRect;
+
+// 이미지 위에 겹쳐 그리는 레이어
+typedef struct overlayLayer
+{
+    int x;                          // 화면 좌표 (화면 회전 전)
+    int y;
+    int width;
+    int height;
+    unsigned int *pPixelArray;      // 상위 8비트는 알파, 하위는 프레임 버퍼 형식 색상 (32BPP는 알파를 미리 곱한 값)
+    bool isVisible;                 // 보이기 여부
+    DirtyRect dirtyRect;            // 마지막 합성 이후 바뀐 영역 (이전 위치와 새 위치를 합친 영역)
+} OverlayLayer;
+
+// 내장 글꼴로 그리는 한 줄짜리 글자 레이어
+typedef struct textOverlay
+{
+    int layerIndex;                         // 글자를 그릴 레이어
+    int columnCount;                        // 최대 글자 수
+    char text[TEXT_OVERLAY_MAX_COLUMN + 1]; // 현재 그려진 글자 (같은 글자로 바꾸면 다시 그리지 않는다.)
+} TextOverlay;
+
+// 비동기 I/O 요청. 완료될 때까지 메모리가 유지되어야 한다.
+typedef struct asyncIORequest
+{
+    int operation;                  // 요청 종류 (ASYNC_IO_READ, ASYNC_IO_WRITE, ASYNC_IO_READAHEAD)
+    int fd;                         // 파일 디스크립터
+    void *pBuffer;                  // 읽거나 쓸 메모리
+    int length;                     // 읽거나 쓸 바이트 수
+    long long offset;               // 파일 내 위치
+    void (*pCompletionCallback)(struct asyncIORequest *pRequest);   // 완료 시 호출할 함수 (기다리지 않는 요청의 정리용)
+    void *pUserData;                // 완료 함수에 넘길 데이터
+    int result;                     // 완료된 바이트 수 또는 -errno
+    bool isCompleted;               // 완료 여부
+    struct asyncIORequest *pNext;   // 작업 스레드 대기 목록
+} AsyncIORequest;
+
+// 측정 시작 시점의 성능 카운터 값과 시각
+typedef struct profileSample
+{
+    long long counterArray[PROFILE_COUNTER_COUNT];
+    long long startTime;            // 나노초
+} ProfileSample;
+
+// 프레임 내보내기 링의 칸 하나의 상태
+typedef struct frameExportSlot
+{
+    unsigned long long sequence;    // 홀수 : 쓰는 중, 짝수 : 프레임 번호 * 2의 프레임이 완성됨
+    long long timestamp;            // 프레임을 내보낸 시각 (CLOCK_MONOTONIC, 나노초)
+} FrameExportSlot;
+
+// 프레임 내보내기 공유 메모리의 헤더. 헤더 뒤 headerSize 위치부터 slotSize 간격으로 프레임 칸이 이어진다.
+// 읽는 쪽은 latestFrame(n)을 읽고, n % slotCount 칸의 sequence가 n * 2인지 확인한 뒤 프레임을 읽고,
+// 다시 읽은 sequence가 같으면 그 프레임을 사용한다. 다르면 읽는 동안 덮어쓴 것이므로 다시 시도한다.
+typedef struct frameExportHeader
+{
+    unsigned int magic;             // FRAME_EXPORT_MAGIC
+    unsigned int version;           // FRAME_EXPORT_VERSION
+    unsigned int headerSize;        // 첫 프레임 칸의 위치 (페이지 크기의 배수)
+    unsigned int slotCount;         // 프레임 칸 수
+    unsigned int slotSize;          // 프레임 칸 간격 (페이지 크기의 배수)
+    unsigned int width;             // 프레임 버퍼 가로 픽셀 수 (회전 전 장치 기준)
+    unsigned int height;            // 프레임 버퍼 세로 픽셀 수 (회전 전 장치 기준)
+    unsigned int stride;            // 한 행의 바이트 수
+    unsigned int bitsPerPixel;      // 16 (RGB565) 또는 32 (XRGB8888)
+    unsigned int rotation;          // 화면 회전 각도 (시계 방향)
+    unsigned long long latestFrame; // 가장 최근에 완성된 프레임 번호 (0이면 아직 없음)
+    FrameExportSlot slotArray[FRAME_EXPORT_SLOT_COUNT];
+} FrameExportHeader;
+
+// 이미지 파일 하나의 메타데이터. 파일 크기와 수정 시각이 같으면 파일을 다시 읽지 않는다.
+typedef struct imageCatalogEntry
+{
+    char fileName[FILE_NAME_MAX_LENGTH + 1];// 파일명
+    bool isValid;                   // 뷰어가 읽을 수 있는 비트맵인지 여부
+    int width;                      // 비트맵 이미지의 가로 크기
+    int height;                     // 비트맵 이미지의 세로 크기
+    int bitCount;                   // 비트맵 이미지의 BPP
+    long long fileSize;             // 파일 크기
+    long long modifiedTime;         // 파일의 수정 시각 (나노초)
+    unsigned long long contentHash; // 파일 전체 내용의 체크섬 (FNV-1a 64비트)
+} ImageCatalogEntry;
+
+// 메타데이터 목록 파일. 파일 전체를 그대로 메모리에 매핑해서 사용한다.
+typedef struct imageCatalog
+{
+    unsigned int magic;             // IMAGE_CATALOG_MAGIC
+    unsigned int version;           // IMAGE_CATALOG_VERSION
+    unsigned int entrySize;         // sizeof(ImageCatalogEntry) (구조체가 바뀌면 다시 만든다.)
+    int entryCount;                 // 사용 중인 항목 수
+    ImageCatalogEntry entryArray[FILE_NAME_ARRAY_SIZE];
+} ImageCatalog;
+
+// 버퍼 풀 사용 통계 (종료할 때 출력한다.)
+typedef struct bufferPoolStatistics
+{
+    long long requestCount;         // 버퍼 요청 수
+    long long reuseCount;           // 놓아둔 블록을 다시 사용한 수
+    long long mapCount;             // 새로 매핑한 블록 수
+    long long unmapCount;           // 한도를 넘어 해제한 블록 수
+    long long overBudgetCount;      // 놓아둔 블록을 모두 해제해도 한도를 넘어 매핑한 수
+    long long inUseBytes;           // 사용 중인 블록 크기의 합
+    long long cachedBytes;          // 다시 쓰려고 놓아둔 블록 크기의 합
+    long long peakBytes;            // 매핑한 블록 크기 합의 최댓값
+    long long hugePageBytes;        // 큰 페이지(MAP_HUGETLB 또는 THP)로 매핑한 블록 크기의 합
+    long long lockedBytes;          // mlock으로 고정한 블록 크기의 합
+} BufferPoolStatistics;
+
 #pragma pack(push, 1)
 typedef struct bmpHeader
 {
@@ -65,17 +323,83 @@ typedef struct bmpHeader
 } BMPHeader;
 #pragma pack(pop)
 
+#pragma pack(push, 1)
+// 프레임 버퍼 형식으로 미리 변환한 파일(.fbraw)의 헤더. 바로 뒤에 픽셀 데이터가 이어진다.
+typedef struct prerenderHeader
+{
+    unsigned int magic;          // 매직 넘버 (PRERENDER_MAGIC)
+    unsigned int version;        // 헤더 버전 (PRERENDER_VERSION)
+    unsigned int headerSize;     // 헤더 크기 (픽셀 데이터의 시작 위치)
+    int width;                   // 프레임 버퍼 가로 크기
+    int height;                  // 프레임 버퍼 세로 크기
+    int stride;                  // 한 행의 바이트 크기
+    int bitsPerPixel;            // 프레임 버퍼 형식 (16 또는 32 BPP)
+    int rotation;                // 변환할 때 적용한 화면 회전 각도
+    int ditherMatrixSize;        // 변환할 때 적용한 디더링 행렬 크기 (16BPP가 아니면 DITHER_NONE)
+    int sourceWidth;             // 원본 비트맵 이미지의 가로 크기
+    int sourceHeight;            // 원본 비트맵 이미지의 세로 크기
+    int sourceBitCount;          // 원본 비트맵 이미지의 BPP
+    long long sourceSize;        // 원본 파일 크기
+    long long sourceModifiedTime;// 원본 파일의 수정 시각 (나노초)
+} PrerenderHeader;
+#pragma pack(pop)
+
 // 값이 지정한 범위를 벗어나지 않도록 한다.
 int thresholding(
     int value,
     const int rangeMin,
     const int rangeMax);
 
+// 단조 증가 시계의 현재 시각 (나노초)
+long long getMonotonicTime();
+
+// 파일의 수정 시각을 나노초 단위로 구한다. (struct stat은 sys/stat.h를 포함한 파일에서만 사용한다.)
+struct stat;
+long long getModifiedTime(const struct stat *pFileStatus);
+
 // 픽셀의 밝기 값을 변화시킨다. 밝기 값의 범위는 0 ~ 255(unsigned char)이다.
 RGBpixel changePixelBrightness(
     RGBpixel pixelBrightness,
     const int pixelBrightnessDelta);
 
+// 색상 조정 값을 기본값(원본과 동일)으로 초기화한다.
+void initColorAdjustment(ColorAdjustment *pColorAdjustment);
+
+// 색상 조정이 원본과 같은 결과를 내는지 확인한다.
+bool isColorAdjustmentIdentity(const ColorAdjustment *pColorAdjustment);
+
+// 한 채널의 8비트 값에 레벨, 대비, 밝기, 감마 조정을 순서대로 적용한다.
+unsigned char adjustColorLevel(
+    const ColorAdjustment *pColorAdjustment,
+    const int channel,
+    const unsigned char value);
+
+// 24비트 픽셀 한 행을 채널별 히스토그램에 더한다.
+void accumulateColorHistogram(
+    ColorHistogram *pColorHistogram,
+    const RGBpixel *pPixelRow,
+    const int width);
+
+// 히스토그램의 양 끝 AUTO_LEVELS_CLIP_PERMILLE 만큼을 잘라낸 범위로 채널별 입력 레벨을 정한다.
+void deriveAutoLevels(
+    ColorAdjustment *pColorAdjustment,
+    const ColorHistogram *pColorHistogram);
+
+// 모든 색상 조정과 프레임 버퍼 픽셀 형식 변환을 채널별 테이블 하나로 합친다.
+void buildColorLUT(
+    ColorLUT *pColorLUT,
+    const ColorAdjustment *pColorAdjustment);
+
+// 16BPP 순서 디더링에 사용할 Bayer 행렬 크기(DITHER_NONE, DITHER_BAYER_4, DITHER_BAYER_8)를 정하고 위치별 보정값 테이블을 만든다.
+void buildDitherTable(const int matrixSize);
+
+// 24비트 픽셀 한 행을 색상 변환 테이블을 거쳐 프레임 버퍼 형식으로 변환한다.
+void convertRowToFrameBuffer(
+    void *pFrameBufferRow,
+    const RGBpixel *pPixelRow,
+    const int width,
+    const ColorLUT *pColorLUT);
+
 // 24비트 RGB 픽셀을 32비트 ABGR 픽셀로 순서 변환과 함께 확장한다.
 unsigned int convertRGB24toABGR32(const RGBpixel pixel);
 
@@ -97,18 +421,78 @@ void searchFilesInPathByExtention(
 // 프레임 버퍼 크기 구하기
 int calculateFrameBufferSize(const struct fb_var_screeninfo fbvar);
 
+// 프레임 버퍼 한 행의 바이트 크기 구하기
+int calculateFrameBufferLineLength(const struct fb_var_screeninfo fbvar);
+
+// 화면 회전을 반영한 화면 가로 크기 (90, 270도 회전이면 프레임 버퍼의 세로 크기)
+int getScreenWidth(const struct fb_var_screeninfo fbvar);
+
+// 화면 회전을 반영한 화면 세로 크기 (90, 270도 회전이면 프레임 버퍼의 가로 크기)
+int getScreenHeight(const struct fb_var_screeninfo fbvar);
+
+// 화면 좌표 (x, y)에 해당하는 프레임 버퍼의 픽셀 위치를 구한다. (시계 방향 회전)
+int calculateFrameBufferPixelOffset(
+    const struct fb_var_screeninfo fbvar,
+    const int x,
+    const int y);
+
+// 화면 좌표의 사각형 영역을 담은 메모리를 회전에 맞게 프레임 버퍼로 옮긴다.
+void blitRegionToFrameBuffer(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    const unsigned char *pSurface,
+    const int surfaceStride,
+    const int x,
+    const int y,
+    const int width,
+    const int height);
+
 // 프레임 버퍼 비우기
 void clearFrameBuffer(
     unsigned int *pfbmap,
     const struct fb_var_screeninfo fbvar);
 
+// 화면 영역을 원본 크기, 좌상단 위치로 초기화한다.
+void initViewport(Viewport *pViewport);
+
+// 화면 중앙을 유지하면서 한 단계 확대(ZOOM_IN) 또는 축소(ZOOM_OUT)한다.
+void zoomViewport(
+    Viewport *pViewport,
+    const struct fb_var_screeninfo fbvar,
+    const BMPHeader *pBitmapHeader,
+    const int zoomDirection);
+
+// 프레임 버퍼의 사각형 영역에만 이미지를 출력한다. 이미지 밖의 영역은 검은색으로 채운다.
+void drawImageRegionOnFrameBuffer(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    BMPHeader *pBitmapHeader,
+    RGBpixel **pBitmapPixel2dArray,
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport,
+    const int regionX,
+    const int regionY,
+    const int regionWidth,
+    const int regionHeight);
+
 // 프레임 버퍼에 이미지 출력
 void drawImageOnFrameBuffer(
     unsigned int *pfbmap,
     const struct fb_var_screeninfo fbvar, 
     BMPHeader *pBitmapHeader,
     RGBpixel **pBitmapPixel2dArray,
-    const int brightness);
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport);
+
+// 화면을 상하좌우로 이동한다. 이미 출력된 부분은 옮기기만 하고 새로 드러난 부분만 다시 그린다.
+void panImageOnFrameBuffer(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    BMPHeader *pBitmapHeader,
+    RGBpixel **pBitmapPixel2dArray,
+    const ColorLUT *pColorLUT,
+    Viewport *pViewport,
+    const int panCommand);
 
 // 프레임 버퍼에서 이미지를 읽어와 24BPP 비트맵 파일에 저장한다.
 void captureFrameBuffer(
@@ -124,11 +508,287 @@ void loadBitmapImage(
     RGBpixel ***pReturnBitmapPixel2dArray,
     const char *pFileName);
 
+// 비트맵 파일을 읽으면서 다 읽은 행 묶음부터 바로 프레임 버퍼에 출력한다. pColorLUT가 NULL이면 읽기만 한다.
+// pColorHistogram이 NULL이 아니면 읽으면서 채널별 히스토그램을 센다.
+void loadBitmapImageProgressive(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    BMPHeader **pReturnBitmapHeader,
+    RGBpixel ***pReturnBitmapPixel2dArray,
+    const char *pFileName,
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport,
+    ColorHistogram *pColorHistogram);
+
+// 비동기 I/O 엔진을 시작한다. io_uring을 사용할 수 없으면 스레드 풀로 대신한다.
+void initAsyncIO(const int preferredEngine);
+
+// 비동기 I/O 엔진의 이름 (io_uring, thread pool, sync)
+const char *getAsyncIOEngineName();
+
+// 요청을 제출한다. 엔진이 시작되지 않았다면 그 자리에서 실행하고 완료시킨다.
+void submitAsyncIO(AsyncIORequest *pRequest);
+
+// 요청이 완료될 때까지 기다리고 결과(완료된 바이트 수 또는 -errno)를 반환한다.
+int waitAsyncIO(AsyncIORequest *pRequest);
+
+// 제출한 모든 요청이 완료될 때까지 기다린다.
+void drainAsyncIO();
+
+// 남은 요청을 모두 끝내고 비동기 I/O 엔진을 멈춘다.
+void closeAsyncIO();
+
+// 곧 열게 될 파일을 페이지 캐시로 미리 읽도록 요청한다. 완료를 기다리지 않는다.
+void prefetchImageFile(const char *pFileName);
+
+// 버퍼 풀의 메모리 한도와 큰 페이지, mlock 사용 여부를 정한다. 버퍼를 요청하기 전에 호출한다.
+void initBufferPool(
+    const long long memoryBudget,
+    const bool isHugePageEnabled,
+    const bool isLockEnabled);
+
+// 화면이나 이미지 크기의 버퍼를 빌린다. 놓아둔 블록 중 크기가 맞는 것이 있으면 다시 쓴다. 내용은 초기화하지 않는다.
+void *allocatePoolBuffer(const size_t size);
+
+// 빌린 버퍼를 돌려준다. 블록은 해제하지 않고 다음 요청을 위해 놓아둔다. NULL이면 아무것도 하지 않는다.
+void releasePoolBuffer(void *pBuffer);
+
+// 버퍼 풀 사용 통계를 복사한다.
+void getBufferPoolStatistics(BufferPoolStatistics *pStatistics);
+
+// 버퍼 풀 사용 통계를 출력한다.
+void printBufferPoolStatistics();
+
+// 놓아둔 블록을 모두 해제한다.
+void closeBufferPool();
+
+// 하드웨어 성능 카운터(사이클, 명령어, 캐시 미스, 분기 예측 실패, 페이지 폴트)를 연다.
+// 열 수 없는 카운터는 건너뛰고 시간만 측정한다.
+void initProfiler();
+
+// 측정을 시작한다. initProfiler를 호출하지 않았다면 아무것도 하지 않는다.
+void beginProfile(ProfileSample *pProfileSample);
+
+// 측정을 끝내고 기능별 카운터 증가량과 메가픽셀당 값을 출력한다.
+void endProfile(
+    const ProfileSample *pProfileSample,
+    const char *pOperationName,
+    const long long pixelCount);
+
+// 열어둔 성능 카운터를 닫는다.
+void closeProfiler();
+
+// 입력 기록 또는 재생을 시작한다. INPUT_TRACE_NONE이면 아무것도 하지 않는다.
+void initInputTrace(
+    const int mode,
+    const char *pFileName,
+    const bool isMaxSpeed);
+
+// 입력 하나를 시각과 함께 기록한다. 기록 중이 아니면 아무것도 하지 않는다.
+void recordInputEvent(const int command);
+
+// 재생 중인지 확인한다.
+bool isInputReplaying();
+
+// 기록 파일에서 다음 입력을 읽는다. 기록된 속도로 재생한다면 기록된 시각까지 기다린다. 기록이 끝나면 -1을 반환한다.
+int readReplayEvent();
+
+// 직전 재생 입력의 처리가 끝났음을 알리고 처리 시간을 출력한다.
+void finishReplayEvent();
+
+// 기록 파일을 닫는다. 재생이었다면 처리 시간 요약을 출력한다.
+void closeInputTrace();
+
+// 메모리 내용의 체크섬 (FNV-1a 64비트)
+unsigned long long calculateChecksum(
+    const void *pData,
+    const size_t size);
+
+// 프레임 버퍼 내용의 체크섬 (FNV-1a 64비트). 재생 결과를 비교하는 데 사용한다.
+unsigned long long calculateFrameBufferChecksum(
+    const unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar);
+
+// POSIX 공유 메모리에 프레임 링을 만든다. 다른 프로세스는 같은 이름으로 매핑해서 최신 프레임을 읽는다.
+void initFrameExport(
+    const char *pName,
+    const struct fb_var_screeninfo fbvar);
+
+// 현재 프레임 버퍼를 링의 다음 칸에 복사하고 최신 프레임 번호를 올린다. 내보내기를 시작하지 않았다면 아무것도 하지 않는다.
+void publishFrame(const unsigned int *pfbmap);
+
+// 프레임 내보내기 공유 메모리를 해제하고 이름을 지운다.
+void closeFrameExport();
+
+// 이미지 디렉토리의 메타데이터 목록 파일을 매핑한다. 파일을 만들 수 없으면 저장하지 않고 메모리에서만 사용한다.
+void openImageCatalog(const char *pPath);
+
+// 파일 목록에 맞춰 메타데이터 목록을 갱신한다. 크기나 수정 시각이 바뀐 파일만 다시 읽고, 없어진 파일은 지운다.
+void updateImageCatalog(unsigned char *pFileNameArray[FILE_NAME_ARRAY_SIZE]);
+
+// 파일의 메타데이터를 찾는다. 목록을 만든 뒤 파일이 바뀌었다면 다시 읽는다.
+const ImageCatalogEntry *getImageCatalogEntry(const char *pFileName);
+
+// 읽을 수 없는 파일과 조건(최소 해상도, 수정 시각)에 맞지 않는 파일을 목록에서 빼고 정렬한다.
+void selectCatalogImageFiles(
+    unsigned char *pFileNameArray[FILE_NAME_ARRAY_SIZE],
+    const int sortKey,
+    const int minimumWidth,
+    const int minimumHeight,
+    const long long minimumModifiedTime);
+
+// 메타데이터 목록을 파일에 쓰고 매핑을 해제한다.
+void closeImageCatalog();
+
+// 8비트 알파와 색상을 레이어 픽셀 형식(상위 8비트는 알파, 하위는 프레임 버퍼 형식 색상)으로 바꾼다.
+unsigned int convertToOverlayPixel(
+    RGBpixel pixel,
+    const unsigned int alpha);
+
+// 완전히 투명한 빈 레이어를 만든다. x, y가 음수이면 화면 오른쪽, 아래쪽 끝에서부터의 거리이다.
+int createOverlayLayer(
+    const struct fb_var_screeninfo fbvar,
+    const int width,
+    const int height,
+    const int x,
+    const int y);
+
+// 레이어의 픽셀 배열 (한 행에 width개씩, 위 행부터)
+unsigned int *getOverlayLayerPixelArray(const int layerIndex);
+
+// 32비트(알파 포함) 비트맵 파일을 레이어로 읽어온다. x, y가 음수이면 화면 오른쪽, 아래쪽 끝에서부터의 거리이다.
+int addOverlayLayer(
+    const struct fb_var_screeninfo fbvar,
+    const char *pFileName,
+    const int x,
+    const int y);
+
+// 레이어를 보이거나 숨긴다. 레이어 영역만 다시 그리도록 표시한다.
+void setOverlayLayerVisible(
+    const int layerIndex,
+    const bool isVisible);
+
+// 레이어의 픽셀 배열을 바꿨음을 알린다. 레이어 영역만 다시 그리도록 표시한다.
+void markOverlayLayerDirty(const int layerIndex);
+
+// 레이어 수
+int getOverlayLayerCount();
+
+// 보이는 레이어가 있는지 확인한다.
+bool hasVisibleOverlayLayer();
+
+// 화면 전체를 다시 그리거나 옮겨서 레이어가 지워졌을 때 모든 레이어 영역을 다시 그리도록 표시한다.
+void invalidateOverlayLayers();
+
+// 화면 내용을 옮긴 뒤 옮겨진 레이어 자국과 레이어 영역을 다시 그리도록 표시한다.
+void scrollOverlayLayers(
+    const int deltaX,
+    const int deltaY);
+
+// 프레임 버퍼 형식으로 변환한 화면 영역(띠)에 보이는 레이어를 순서대로 합성한다.
+void blendOverlayLayers(
+    unsigned char *pSurface,
+    const int surfaceStride,
+    const int x,
+    const int y,
+    const int width,
+    const int height);
+
+// 다시 그리도록 표시된 영역만 이미지와 레이어를 합성해서 다시 그린다. 이미지가 없다면 검은 배경 위에 합성한다.
+void compositeOverlayLayers(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    BMPHeader *pBitmapHeader,
+    RGBpixel **pBitmapPixel2dArray,
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport);
+
+// 프레임 버퍼를 비우고 검은 배경 위에 레이어를 다시 그린다.
+void clearFrameBufferUnderOverlays(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport);
+
+// 한 줄짜리 글자 레이어를 만든다. x, y가 음수이면 화면 오른쪽, 아래쪽 끝에서부터의 거리이다.
+int addTextOverlay(
+    const struct fb_var_screeninfo fbvar,
+    const int columnCount,
+    const int x,
+    const int y);
+
+// 글자 레이어의 내용을 바꾼다. 바뀐 경우에만 레이어 영역을 다시 그리도록 표시한다.
+void setTextOverlay(
+    const int textIndex,
+    const char *pText);
+
+// 글자 레이어에 현재 시각(HH:MM:SS)을 쓴다. 초가 바뀌어 레이어를 다시 그려야 하면 true를 반환한다.
+bool updateClockOverlay(const int textIndex);
+
+// 뷰어가 읽을 수 있는 비트맵(24BPP)인지 헤더와 파일 크기로 확인한다.
+bool isSupportedBitmapHeader(
+    const BMPHeader *pBitmapHeader,
+    const long long fileSize);
+
 // 읽어온 이미지가 있는지 확인한다.
 bool isImageLoaded(
     BMPHeader *pBitmapHeader,
     RGBpixel **pBitmapPixel2dArray);
 
+// loadBitmapImage로 버퍼 풀에서 빌린 비트맵 헤더와 이미지를 돌려준다.
+void freeBitmapImage(
+    BMPHeader *pBitmapHeader,
+    RGBpixel **pBitmapPixel2dArray);
+
+// 원본 파일명에 대응하는 미리 변환한 파일명을 만든다. (image.bmp -> image.fbraw)
+void makePrerenderFileName(
+    char *pPrerenderFileName,
+    const char *pSourceFileName);
+
+// 비트맵 파일 하나를 프레임 버퍼 형식으로 변환해 저장한다. 지원하지 않는 파일이면 false를 반환한다.
+bool prerenderImageFile(
+    const char *pSourceFileName,
+    const char *pPrerenderFileName,
+    const struct fb_var_screeninfo fbvar);
+
+// 번호가 붙은 비트맵 파일들을 지정한 fps로 반복 재생한다. (loopCount가 0이면 종료 시그널까지 반복)
+void playImageSequence(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    const char *pPattern,
+    const int framesPerSecond,
+    const int loopCount,
+    const int decoderCount,
+    const long long memoryBudget,
+    const ColorLUT *pColorLUT);
+
+// 경로 안의 모든 비트맵 파일을 여러 스레드로 나누어 미리 변환한다. 실패한 파일 수를 반환한다.
+int prerenderImagesInPath(
+    const char *pTargetPath,
+    const struct fb_var_screeninfo fbvar,
+    const int jobCount);
+
+// 원본보다 최신인 미리 변환한 파일이 있으면 프레임 버퍼에 그대로 복사하고 true를 반환한다.
+bool displayPrerenderedImage(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    const char *pSourceFileName,
+    PrerenderHeader *pReturnPrerenderHeader);
+
+// 명령행 인자가 지정한 옵션이면 '=' 뒤의 값을, 아니면 NULL을 반환한다.
+const char *matchCommandLineOption(
+    const char *pArgument,
+    const char *pOptionName);
+
+// 콘솔에서 한 줄을 읽어 명령으로 바꾼다. 숫자는 버튼 번호, w/a/s/d는 이동, +/-는 확대/축소이다.
+int readConsoleCommand();
+
+// 다음 초가 시작될 때까지만 콘솔 입력을 기다린다. 입력이 들어왔으면 true를 반환한다.
+bool waitConsoleInputUntilNextSecond();
+
+// 이동 모드에서는 방향키 위치의 버튼(2, 4, 6, 8)을 이동 명령으로 바꾼다.
+int translatePanModeCommand(const int pushSwitchValue);
+
 // 프로그램 사용법을 콘솔에 출력한다.
 void printUsageOnConsole();
 
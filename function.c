@@ -3,9 +3,14 @@
 #include <stdbool.h> 
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
 #include <linux/fb.h>
 #include <dirent.h>
 #include <string.h>
+#include <math.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/stat.h>
 
 #include "fbbmp.h"
 
@@ -21,6 +26,20 @@ int thresholding(
     return value;
 }
 
+// 단조 증가 시계의 현재 시각 (나노초). 측정, 기록, 재생 시각은 모두 이 시계를 기준으로 한다.
+long long getMonotonicTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// 파일의 수정 시각을 나노초 단위로 구한다. 메타데이터 목록과 미리 변환한 파일이 원본이 바뀌었는지 확인할 때 사용한다.
+long long getModifiedTime(const struct stat *pFileStatus)
+{
+    return (long long)pFileStatus->st_mtim.tv_sec * 1000000000LL + pFileStatus->st_mtim.tv_nsec;
+}
+
 // 픽셀의 밝기 값을 변화시킨다. 밝기 값의 범위는 0 ~ 255(unsigned char)이다.
 RGBpixel changePixelBrightness(
     RGBpixel pixelBrightness,
@@ -33,6 +52,243 @@ RGBpixel changePixelBrightness(
     return pixelBrightness;
 }
 
+// 색상 조정 값을 기본값(원본과 동일)으로 초기화한다.
+void initColorAdjustment(ColorAdjustment *pColorAdjustment)
+{
+    pColorAdjustment->brightness = 0;
+    pColorAdjustment->contrast = CONTRAST_DEFAULT;
+    pColorAdjustment->gamma = GAMMA_DEFAULT;
+
+    for (int channel = 0; channel < COLOR_CHANNEL_COUNT; channel++)
+    {
+        pColorAdjustment->levelsLow[channel] = UCHAR_MIN;
+        pColorAdjustment->levelsHigh[channel] = UCHAR_MAX;
+    }
+}
+
+// 색상 조정이 원본과 같은 결과를 내는지 확인한다.
+bool isColorAdjustmentIdentity(const ColorAdjustment *pColorAdjustment)
+{
+    for (int channel = 0; channel < COLOR_CHANNEL_COUNT; channel++)
+    {
+        if (pColorAdjustment->levelsLow[channel] != UCHAR_MIN || pColorAdjustment->levelsHigh[channel] != UCHAR_MAX)
+        {
+            return false;
+        }
+    }
+
+    return pColorAdjustment->brightness == 0
+        && pColorAdjustment->contrast == CONTRAST_DEFAULT
+        && pColorAdjustment->gamma == GAMMA_DEFAULT;
+}
+
+// 한 채널의 8비트 값에 레벨, 대비, 밝기, 감마 조정을 순서대로 적용한다.
+unsigned char adjustColorLevel(
+    const ColorAdjustment *pColorAdjustment,
+    const int channel,
+    const unsigned char value)
+{
+    // 레벨 : 입력 범위 [하한, 상한]을 [0, 255]로 늘린다.
+    const int levelLow = pColorAdjustment->levelsLow[channel];
+    const int levelHigh = pColorAdjustment->levelsHigh[channel];
+    int level = value;
+    if (levelHigh > levelLow)
+    {
+        level = thresholding((level - levelLow) * UCHAR_MAX / (levelHigh - levelLow), UCHAR_MIN, UCHAR_MAX);
+    }
+
+    // 대비 : 중간값(128)을 기준으로 거리를 늘리거나 줄인다.
+    level = thresholding((level - 128) * pColorAdjustment->contrast / CONTRAST_DEFAULT + 128, UCHAR_MIN, UCHAR_MAX);
+
+    // 밝기 : 기존 밝기 조절 기능과 동일하게 더한다.
+    level = thresholding(level + pColorAdjustment->brightness, UCHAR_MIN, UCHAR_MAX);
+
+    // 감마 : 1/gamma 제곱으로 중간 밝기를 보정한다.
+    if (pColorAdjustment->gamma > 0 && pColorAdjustment->gamma != GAMMA_DEFAULT)
+    {
+        level = (int)(pow((double)level / UCHAR_MAX, 1.0 / pColorAdjustment->gamma) * UCHAR_MAX + 0.5);
+        level = thresholding(level, UCHAR_MIN, UCHAR_MAX);
+    }
+
+    return level;
+}
+
+// 24비트 픽셀 한 행을 채널별 히스토그램에 더한다.
+// 이웃한 픽셀은 값이 같은 경우가 많아서 한 히스토그램에 세면 같은 칸의 읽기가 직전 쓰기를 기다리게 된다.
+// 픽셀마다 돌아가며 다른 사본에 세면 이 의존이 끊겨서 여러 픽셀의 갱신이 동시에 진행된다.
+void accumulateColorHistogram(
+    ColorHistogram *pColorHistogram,
+    const RGBpixel *pPixelRow,
+    const int width)
+{
+    int columnIndex = 0;
+    for (; columnIndex + HISTOGRAM_COPY_COUNT <= width; columnIndex += HISTOGRAM_COPY_COUNT)
+    {
+        for (int copyIndex = 0; copyIndex < HISTOGRAM_COPY_COUNT; copyIndex++)
+        {
+            const RGBpixel pixel = pPixelRow[columnIndex + copyIndex];
+            pColorHistogram->count[copyIndex][COLOR_CHANNEL_BLUE][pixel.blue]++;
+            pColorHistogram->count[copyIndex][COLOR_CHANNEL_GREEN][pixel.green]++;
+            pColorHistogram->count[copyIndex][COLOR_CHANNEL_RED][pixel.red]++;
+        }
+    }
+
+    for (; columnIndex < width; columnIndex++)
+    {
+        const RGBpixel pixel = pPixelRow[columnIndex];
+        pColorHistogram->count[0][COLOR_CHANNEL_BLUE][pixel.blue]++;
+        pColorHistogram->count[0][COLOR_CHANNEL_GREEN][pixel.green]++;
+        pColorHistogram->count[0][COLOR_CHANNEL_RED][pixel.red]++;
+    }
+}
+
+// 히스토그램의 양 끝 AUTO_LEVELS_CLIP_PERMILLE 만큼을 잘라낸 범위로 채널별 입력 레벨을 정한다.
+// 잘라낸 범위가 한 값으로 모이는 채널(단색)은 레벨을 원본 그대로 둔다.
+void deriveAutoLevels(
+    ColorAdjustment *pColorAdjustment,
+    const ColorHistogram *pColorHistogram)
+{
+    for (int channel = 0; channel < COLOR_CHANNEL_COUNT; channel++)
+    {
+        // 사본들을 합친다.
+        unsigned long long count[COLOR_LUT_SIZE] = {0};
+        unsigned long long totalCount = 0;
+        for (int value = 0; value < COLOR_LUT_SIZE; value++)
+        {
+            for (int copyIndex = 0; copyIndex < HISTOGRAM_COPY_COUNT; copyIndex++)
+            {
+                count[value] += pColorHistogram->count[copyIndex][channel][value];
+            }
+            totalCount += count[value];
+        }
+
+        // 어두운 쪽과 밝은 쪽에서 각각 잘라낼 픽셀 수를 넘는 첫 값을 찾는다.
+        const unsigned long long clipCount = totalCount * AUTO_LEVELS_CLIP_PERMILLE / 1000;
+        unsigned long long accumulatedCount = 0;
+        int levelLow = UCHAR_MIN;
+        while (levelLow < UCHAR_MAX && (accumulatedCount += count[levelLow]) <= clipCount)
+        {
+            levelLow++;
+        }
+
+        accumulatedCount = 0;
+        int levelHigh = UCHAR_MAX;
+        while (levelHigh > UCHAR_MIN && (accumulatedCount += count[levelHigh]) <= clipCount)
+        {
+            levelHigh--;
+        }
+
+        pColorAdjustment->levelsLow[channel] = (levelLow < levelHigh) ? levelLow : UCHAR_MIN;
+        pColorAdjustment->levelsHigh[channel] = (levelLow < levelHigh) ? levelHigh : UCHAR_MAX;
+    }
+}
+
+// 모든 색상 조정과 프레임 버퍼 픽셀 형식 변환을 채널별 테이블 하나로 합친다.
+// 픽셀 형식 변환은 채널별로 시프트한 값을 OR 하는 것이므로 채널마다 따로 변환해 두어도 결과가 같다.
+void buildColorLUT(
+    ColorLUT *pColorLUT,
+    const ColorAdjustment *pColorAdjustment)
+{
+    for (int value = 0; value < COLOR_LUT_SIZE; value++)
+    {
+        RGBpixel pixelBlue = {0};
+        RGBpixel pixelGreen = {0};
+        RGBpixel pixelRed = {0};
+        pixelBlue.blue = adjustColorLevel(pColorAdjustment, COLOR_CHANNEL_BLUE, value);
+        pixelGreen.green = adjustColorLevel(pColorAdjustment, COLOR_CHANNEL_GREEN, value);
+        pixelRed.red = adjustColorLevel(pColorAdjustment, COLOR_CHANNEL_RED, value);
+
+        if (frameBufferBPP == BPP_16)
+        {
+            pColorLUT->blue[value] = convertRGB24toBGR16(pixelBlue);
+            pColorLUT->green[value] = convertRGB24toBGR16(pixelGreen);
+            pColorLUT->red[value] = convertRGB24toBGR16(pixelRed);
+
+            // 순서 디더링용 : 보정값을 더한 뒤 하위 비트를 버린다. 넘친 값은 최댓값으로 맞춘다.
+            // 초록은 버리는 비트가 하나 적으므로 보정값의 절반을 더한다.
+            for (int bias = 0; bias < DITHER_BIAS_COUNT; bias++)
+            {
+                pColorLUT->dither[bias][COLOR_CHANNEL_BLUE][value] = MIN(31, (pixelBlue.blue + bias) >> 3) << 11;
+                pColorLUT->dither[bias][COLOR_CHANNEL_GREEN][value] = MIN(63, (pixelGreen.green + bias / 2) >> 2) << 5;
+                pColorLUT->dither[bias][COLOR_CHANNEL_RED][value] = MIN(31, (pixelRed.red + bias) >> 3) << 0;
+            }
+        }
+        else
+        {
+            pColorLUT->blue[value] = convertRGB24toABGR32(pixelBlue);
+            pColorLUT->green[value] = convertRGB24toABGR32(pixelGreen);
+            pColorLUT->red[value] = convertRGB24toABGR32(pixelRed);
+        }
+    }
+}
+
+// 16BPP 순서 디더링의 위치별 보정값 (0 ~ DITHER_BIAS_COUNT-1). 색상 변환 테이블의 보정값별 테이블을 고르는 데 사용한다.
+static unsigned char ditherBiasTable[DITHER_MATRIX_MAX][DITHER_MATRIX_MAX];
+
+// 16BPP 순서 디더링에 사용할 Bayer 행렬 크기를 정하고 위치별 보정값 테이블을 만든다.
+// 크기 n의 행렬에서 2n의 행렬을 만든다. (M2n = [4Mn, 4Mn+2; 4Mn+3, 4Mn+1])
+void buildDitherTable(const int matrixSize)
+{
+    ditherMatrixSize = matrixSize;
+    if (matrixSize == DITHER_NONE)
+    {
+        return;
+    }
+
+    int bayerMatrix[DITHER_MATRIX_MAX][DITHER_MATRIX_MAX] = {{0}};
+    for (int size = 1; size < matrixSize; size *= 2)
+    {
+        for (int y = 0; y < size; y++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                const int value = bayerMatrix[y][x] * 4;
+                bayerMatrix[y][x] = value;
+                bayerMatrix[y][x + size] = value + 2;
+                bayerMatrix[y + size][x] = value + 3;
+                bayerMatrix[y + size][x + size] = value + 1;
+            }
+        }
+    }
+
+    // 행렬 값(0 ~ n*n-1)을 보정값 범위로 고르게 나눈다.
+    for (int y = 0; y < matrixSize; y++)
+    {
+        for (int x = 0; x < matrixSize; x++)
+        {
+            ditherBiasTable[y][x] = bayerMatrix[y][x] * DITHER_BIAS_COUNT / (matrixSize * matrixSize);
+        }
+    }
+}
+
+// 24비트 픽셀 한 행을 색상 변환 테이블을 거쳐 프레임 버퍼 형식으로 변환한다.
+// 색상 조정이 몇 개가 켜져 있든 픽셀당 테이블 조회 3번으로 끝난다.
+void convertRowToFrameBuffer(
+    void *pFrameBufferRow,
+    const RGBpixel *pPixelRow,
+    const int width,
+    const ColorLUT *pColorLUT)
+{
+    if (frameBufferBPP == BPP_16)
+    {
+        unsigned short *pDestination = (unsigned short *)pFrameBufferRow;
+        for (int columnIndex = 0; columnIndex < width; columnIndex++)
+        {
+            const RGBpixel pixel = pPixelRow[columnIndex];
+            pDestination[columnIndex] = pColorLUT->blue[pixel.blue] | pColorLUT->green[pixel.green] | pColorLUT->red[pixel.red];
+        }
+    }
+    else
+    {
+        unsigned int *pDestination = (unsigned int *)pFrameBufferRow;
+        for (int columnIndex = 0; columnIndex < width; columnIndex++)
+        {
+            const RGBpixel pixel = pPixelRow[columnIndex];
+            pDestination[columnIndex] = pColorLUT->blue[pixel.blue] | pColorLUT->green[pixel.green] | pColorLUT->red[pixel.red];
+        }
+    }
+}
+
 // 24비트 RGB 픽셀을 32비트 ABGR 픽셀로 순서 변환과 함께 확장한다.
 unsigned int convertRGB24toABGR32(const RGBpixel pixel)
 {
@@ -42,9 +298,10 @@ unsigned int convertRGB24toABGR32(const RGBpixel pixel)
 }
 
 // 24비트 RGB 픽셀을 16비트 BGR 픽셀로 순서 변환과 함께 축소한다.
+// 각 채널의 하위 비트를 버려 5비트(파랑), 6비트(초록), 5비트(빨강)로 맞춘다.
 unsigned short convertRGB24toBGR16(const RGBpixel pixel)
 {
-    return ((pixel.blue << 11) | (pixel.green << 6) | (pixel.red << 0));
+    return (((pixel.blue >> 3) << 11) | ((pixel.green >> 2) << 5) | ((pixel.red >> 3) << 0));
 }
 
 // 16비트 BGR 픽셀을 24비트 BGR 픽셀로 확장한다.
@@ -62,12 +319,12 @@ unsigned int convertBGR16toBGR24(const unsigned short pixel)
 
     // 공백 제거
     blue = blue >> 11;                         // 00000 000000 11111
-    green = green >> 6;                        // 00000 000000 11111
+    green = green >> 5;                        // 00000 000000 111111
     red = red >> 0;                            // 00000 000000 11111
 
     // 24비트에 맞춰 확장 준비
     blue = blue << 3;                          // 00000 000111 11000
-    green = green << 3;                        // 00000 000111 11000
+    green = green << 2;                        // 00000 000111 11100
     red = red << 3;                            // 00000 000111 11000
 
     return ((blue << 16) | (green << 8) | (red << 0));
@@ -136,6 +393,138 @@ int calculateFrameBufferSize(const struct fb_var_screeninfo fbvar)
     return fbvar.xres_virtual * fbvar.yres_virtual * (frameBufferBPP / 8);
 }
 
+// 프레임 버퍼 한 행의 바이트 크기 구하기
+int calculateFrameBufferLineLength(const struct fb_var_screeninfo fbvar)
+{
+    // 가로 * BPP에 따른 바이트 크기 (32BPP : 4Bytes / 16BPP : 2Bytes)
+    return fbvar.xres_virtual * (frameBufferBPP / 8);
+}
+
+// 화면 회전을 반영한 화면 가로 크기 (90, 270도 회전이면 프레임 버퍼의 세로 크기)
+int getScreenWidth(const struct fb_var_screeninfo fbvar)
+{
+    return (displayRotation == ROTATION_90 || displayRotation == ROTATION_270) ? fbvar.yres_virtual : fbvar.xres_virtual;
+}
+
+// 화면 회전을 반영한 화면 세로 크기 (90, 270도 회전이면 프레임 버퍼의 가로 크기)
+int getScreenHeight(const struct fb_var_screeninfo fbvar)
+{
+    return (displayRotation == ROTATION_90 || displayRotation == ROTATION_270) ? fbvar.xres_virtual : fbvar.yres_virtual;
+}
+
+// 화면 좌표 (x, y)에 해당하는 프레임 버퍼의 픽셀 위치를 구한다. (시계 방향 회전)
+int calculateFrameBufferPixelOffset(
+    const struct fb_var_screeninfo fbvar,
+    const int x,
+    const int y)
+{
+    const int width = fbvar.xres_virtual;
+    const int height = fbvar.yres_virtual;
+
+    switch (displayRotation)
+    {
+        case ROTATION_90: return width * x + (width - 1 - y);
+        case ROTATION_180: return width * (height - 1 - y) + (width - 1 - x);
+        case ROTATION_270: return width * (height - 1 - x) + y;
+    }
+    return width * y + x;
+}
+
+// 화면 좌표의 사각형 영역 [x, x + width) * [y, y + height)를 담은 메모리를 회전에 맞게 프레임 버퍼로 옮긴다.
+// 0도는 행 단위 복사, 180도는 행을 거꾸로 읽으며 순서대로 쓰고, 90, 270도는 정사각형 블록 단위로 전치한다.
+void blitRegionToFrameBuffer(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    const unsigned char *pSurface,
+    const int surfaceStride,
+    const int x,
+    const int y,
+    const int width,
+    const int height)
+{
+    const int lineLength = calculateFrameBufferLineLength(fbvar);
+    const int bytesPerPixel = frameBufferBPP / 8;
+
+    if (displayRotation == ROTATION_0)
+    {
+        for (int rowIndex = 0; rowIndex < height; rowIndex++)
+        {
+            memcpy((unsigned char *)pfbmap + lineLength * (y + rowIndex) + x * bytesPerPixel,
+                pSurface + surfaceStride * rowIndex,
+                width * bytesPerPixel);
+        }
+        return;
+    }
+
+    if (displayRotation == ROTATION_180)
+    {
+        // 화면 행 하나가 프레임 버퍼 행 하나에 거꾸로 대응하므로 쓰는 쪽 주소는 계속 증가한다.
+        for (int rowIndex = 0; rowIndex < height; rowIndex++)
+        {
+            const int offset = calculateFrameBufferPixelOffset(fbvar, x + width - 1, y + rowIndex);
+            if (bytesPerPixel == 2)
+            {
+                const unsigned short *pSource = (const unsigned short *)(pSurface + surfaceStride * rowIndex);
+                unsigned short *pDestination = (unsigned short *)pfbmap + offset;
+                for (int columnIndex = 0; columnIndex < width; columnIndex++)
+                {
+                    pDestination[columnIndex] = pSource[width - 1 - columnIndex];
+                }
+            }
+            else
+            {
+                const unsigned int *pSource = (const unsigned int *)(pSurface + surfaceStride * rowIndex);
+                unsigned int *pDestination = pfbmap + offset;
+                for (int columnIndex = 0; columnIndex < width; columnIndex++)
+                {
+                    pDestination[columnIndex] = pSource[width - 1 - columnIndex];
+                }
+            }
+        }
+        return;
+    }
+
+    // 90도는 화면 열 하나가 프레임 버퍼 행 하나(오른쪽에서 왼쪽)에, 270도는 (왼쪽에서 오른쪽)에 대응한다.
+    // ROTATION_TILE_SIZE * ROTATION_TILE_SIZE 블록 단위로 전치해서, 블록 하나를 옮기는 동안 읽는 행과 쓰는 행이
+    // 각각 ROTATION_TILE_SIZE개의 캐시 라인 안에 머물게 한다. (영역 높이 전체를 한 열씩 옮기면 읽는 캐시 라인이 높이만큼 필요하다.)
+    const int surfaceRowStep = (displayRotation == ROTATION_90) ? -surfaceStride : surfaceStride;
+    for (int tileY = 0; tileY < height; tileY += ROTATION_TILE_SIZE)
+    {
+        const int tileHeight = MIN(ROTATION_TILE_SIZE, height - tileY);
+
+        // 프레임 버퍼 행에서 블록의 가장 왼쪽에 오는 화면 행 : 90도는 블록의 가장 아래 행, 270도는 가장 위 행
+        const int firstRow = (displayRotation == ROTATION_90) ? tileY + tileHeight - 1 : tileY;
+
+        for (int tileX = 0; tileX < width; tileX += ROTATION_TILE_SIZE)
+        {
+            const int tileWidth = MIN(ROTATION_TILE_SIZE, width - tileX);
+
+            for (int columnIndex = tileX; columnIndex < tileX + tileWidth; columnIndex++)
+            {
+                const int offset = calculateFrameBufferPixelOffset(fbvar, x + columnIndex, y + firstRow);
+                const unsigned char *pSource = pSurface + surfaceStride * firstRow + columnIndex * bytesPerPixel;
+
+                if (bytesPerPixel == 2)
+                {
+                    unsigned short *pDestination = (unsigned short *)pfbmap + offset;
+                    for (int rowIndex = 0; rowIndex < tileHeight; rowIndex++)
+                    {
+                        pDestination[rowIndex] = *(const unsigned short *)(pSource + surfaceRowStep * rowIndex);
+                    }
+                }
+                else
+                {
+                    unsigned int *pDestination = pfbmap + offset;
+                    for (int rowIndex = 0; rowIndex < tileHeight; rowIndex++)
+                    {
+                        pDestination[rowIndex] = *(const unsigned int *)(pSource + surfaceRowStep * rowIndex);
+                    }
+                }
+            }
+        }
+    }
+}
+
 // 프레임 버퍼 비우기
 void clearFrameBuffer(
     unsigned int *pfbmap,
@@ -145,37 +534,422 @@ void clearFrameBuffer(
     system("clear");
 }
 
-// 프레임 버퍼에 이미지 출력
-void drawImageOnFrameBuffer(
+// 확대, 축소 단계. {확대 배율, 축소 배율} 순서이며 모두 정수 배율이다.
+static const int zoomSteps[][2] = {{1, 4}, {1, 3}, {1, 2}, {1, 1}, {2, 1}, {3, 1}, {4, 1}, {6, 1}, {8, 1}};
+#define ZOOM_STEP_COUNT ((int)(sizeof(zoomSteps) / sizeof(zoomSteps[0])))
+
+// 화면 영역을 원본 크기, 좌상단 위치로 초기화한다.
+void initViewport(Viewport *pViewport)
+{
+    pViewport->zoomIn = 1;
+    pViewport->zoomOut = 1;
+    pViewport->originX = 0;
+    pViewport->originY = 0;
+}
+
+// 화면 영역이 이미지 밖으로 나가지 않도록 좌표를 제한한다.
+// 축소 중에는 이동해도 샘플링 위치가 바뀌지 않도록 좌표를 축소 배율의 배수로 맞춘다.
+static void clampViewport(
+    Viewport *pViewport,
+    const struct fb_var_screeninfo fbvar,
+    const BMPHeader *pBitmapHeader)
+{
+    const int visibleWidth = (getScreenWidth(fbvar) * pViewport->zoomOut + pViewport->zoomIn - 1) / pViewport->zoomIn;
+    const int visibleHeight = (getScreenHeight(fbvar) * pViewport->zoomOut + pViewport->zoomIn - 1) / pViewport->zoomIn;
+
+    pViewport->originX = thresholding(pViewport->originX, 0, MAX(0, pBitmapHeader->biWidth - visibleWidth));
+    pViewport->originY = thresholding(pViewport->originY, 0, MAX(0, pBitmapHeader->biHeight - visibleHeight));
+    pViewport->originX -= pViewport->originX % pViewport->zoomOut;
+    pViewport->originY -= pViewport->originY % pViewport->zoomOut;
+}
+
+// 화면 중앙을 유지하면서 한 단계 확대(ZOOM_IN) 또는 축소(ZOOM_OUT)한다.
+void zoomViewport(
+    Viewport *pViewport,
+    const struct fb_var_screeninfo fbvar,
+    const BMPHeader *pBitmapHeader,
+    const int zoomDirection)
+{
+    // 현재 배율에 해당하는 단계를 찾는다.
+    int zoomStep = 0;
+    while (zoomStep < ZOOM_STEP_COUNT - 1 && (zoomSteps[zoomStep][0] != pViewport->zoomIn || zoomSteps[zoomStep][1] != pViewport->zoomOut))
+    {
+        zoomStep++;
+    }
+    zoomStep = thresholding(zoomStep + zoomDirection, 0, ZOOM_STEP_COUNT - 1);
+
+    // 화면 중앙에 있던 이미지 좌표를 새 배율에서도 화면 중앙에 둔다.
+    const int centerX = pViewport->originX + (getScreenWidth(fbvar) / 2) * pViewport->zoomOut / pViewport->zoomIn;
+    const int centerY = pViewport->originY + (getScreenHeight(fbvar) / 2) * pViewport->zoomOut / pViewport->zoomIn;
+
+    pViewport->zoomIn = zoomSteps[zoomStep][0];
+    pViewport->zoomOut = zoomSteps[zoomStep][1];
+    pViewport->originX = centerX - (getScreenWidth(fbvar) / 2) * pViewport->zoomOut / pViewport->zoomIn;
+    pViewport->originY = centerY - (getScreenHeight(fbvar) / 2) * pViewport->zoomOut / pViewport->zoomIn;
+
+    clampViewport(pViewport, fbvar, pBitmapHeader);
+}
+
+// 24비트 픽셀 한 행을 sampleStep 간격으로 건너뛰며 프레임 버퍼 형식으로 변환한다.
+static void convertSampledRowToFrameBuffer(
+    void *pFrameBufferRow,
+    const RGBpixel *pPixelRow,
+    const int width,
+    const int sampleStep,
+    const ColorLUT *pColorLUT)
+{
+    if (frameBufferBPP == BPP_16)
+    {
+        unsigned short *pDestination = (unsigned short *)pFrameBufferRow;
+        for (int columnIndex = 0; columnIndex < width; columnIndex++)
+        {
+            const RGBpixel pixel = pPixelRow[columnIndex * sampleStep];
+            pDestination[columnIndex] = pColorLUT->blue[pixel.blue] | pColorLUT->green[pixel.green] | pColorLUT->red[pixel.red];
+        }
+    }
+    else
+    {
+        unsigned int *pDestination = (unsigned int *)pFrameBufferRow;
+        for (int columnIndex = 0; columnIndex < width; columnIndex++)
+        {
+            const RGBpixel pixel = pPixelRow[columnIndex * sampleStep];
+            pDestination[columnIndex] = pColorLUT->blue[pixel.blue] | pColorLUT->green[pixel.green] | pColorLUT->red[pixel.red];
+        }
+    }
+}
+
+// 같은 프레임 버퍼 픽셀을 연속으로 채운다. 픽셀을 반복한 64비트 값으로 한 번에 여러 픽셀씩 쓴다.
+static void fillFrameBufferPixels(
+    unsigned char *pDestination,
+    const unsigned int pixel,
+    int count)
+{
+    const int bytesPerPixel = frameBufferBPP / 8;
+    const unsigned long long widePixel = (frameBufferBPP == BPP_16)
+        ? (unsigned long long)(unsigned short)pixel * 0x0001000100010001ULL
+        : (unsigned long long)pixel * 0x0000000100000001ULL;
+    const int pixelsPerStore = sizeof(widePixel) / bytesPerPixel;
+
+    for (; count >= pixelsPerStore; count -= pixelsPerStore)
+    {
+        memcpy(pDestination, &widePixel, sizeof(widePixel));
+        pDestination += sizeof(widePixel);
+    }
+    memcpy(pDestination, &widePixel, count * bytesPerPixel);
+}
+
+// 이미지 한 행에서 화면 열 [screenX, screenX + width)에 해당하는 부분을 순서 디더링해서 16BPP로 변환하고 변환한 열 수를 반환한다.
+// 디더링 위치는 화면이 아니라 시점 원점을 포함한 좌표로 정하므로, 이동(pan)으로 옮긴 부분과 새로 그린 부분의 무늬가 이어진다.
+// 행마다 열 위치별 보정값 테이블을 골라두므로 픽셀당 테이블 조회 3번으로 끝나 디더링하지 않는 변환과 비용이 같다.
+static int ditherViewportRowToBGR16(
+    unsigned short *pDestination,
+    const RGBpixel *pPixelRow,
+    const int imageWidth,
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport,
+    const int screenX,
+    const int screenY,
+    const int width)
+{
+    const int zoomIn = pViewport->zoomIn;
+    const int zoomOut = pViewport->zoomOut;
+    const int renderedWidth = thresholding(((imageWidth - pViewport->originX) * zoomIn + zoomOut - 1) / zoomOut - screenX, 0, width);
+
+    // 이 행에서 열 위치(행렬 크기로 나눈 나머지)마다 사용할 테이블
+    const int phaseMask = ditherMatrixSize - 1;
+    const int ditherX = pViewport->originX * zoomIn / zoomOut + screenX;
+    const int ditherY = (pViewport->originY * zoomIn / zoomOut + screenY) & phaseMask;
+    const unsigned short (*pTableArray[DITHER_MATRIX_MAX])[COLOR_LUT_SIZE];
+    for (int phase = 0; phase < ditherMatrixSize; phase++)
+    {
+        pTableArray[phase] = pColorLUT->dither[ditherBiasTable[ditherY][(ditherX + phase) & phaseMask]];
+    }
+
+    // 화면 열에 대응하는 이미지 열 (imageX = originX + (screenX + i) * zoomOut / zoomIn)
+    // 확대하지 않을 때는 일정한 간격이므로 나머지를 따라가지 않는다.
+    if (zoomIn == 1)
+    {
+        const RGBpixel *pPixel = pPixelRow + pViewport->originX + screenX * zoomOut;
+        for (int columnIndex = 0; columnIndex < renderedWidth; columnIndex++, pPixel += zoomOut)
+        {
+            const unsigned short (*pTable)[COLOR_LUT_SIZE] = pTableArray[columnIndex & phaseMask];
+            pDestination[columnIndex] = pTable[COLOR_CHANNEL_BLUE][pPixel->blue] | pTable[COLOR_CHANNEL_GREEN][pPixel->green] | pTable[COLOR_CHANNEL_RED][pPixel->red];
+        }
+        return renderedWidth;
+    }
+
+    for (int columnIndex = 0; columnIndex < renderedWidth; columnIndex++)
+    {
+        const RGBpixel pixel = pPixelRow[pViewport->originX + (screenX + columnIndex) * zoomOut / zoomIn];
+        const unsigned short (*pTable)[COLOR_LUT_SIZE] = pTableArray[columnIndex & phaseMask];
+        pDestination[columnIndex] = pTable[COLOR_CHANNEL_BLUE][pixel.blue] | pTable[COLOR_CHANNEL_GREEN][pixel.green] | pTable[COLOR_CHANNEL_RED][pixel.red];
+    }
+
+    return renderedWidth;
+}
+
+// 이미지 한 행에서 화면 열 [screenX, screenX + width)에 해당하는 부분을 프레임 버퍼 형식으로 변환한다.
+// 원본 크기, 정수 배율 확대(픽셀 복제), 정수 배율 축소(픽셀 건너뛰기)를 각각 따로 처리한다. screenY는 디더링 위치에만 사용한다.
+static void renderViewportRow(
+    unsigned char *pDestination,
+    const RGBpixel *pPixelRow,
+    const int imageWidth,
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport,
+    const int screenX,
+    const int screenY,
+    const int width)
+{
+    const int bytesPerPixel = frameBufferBPP / 8;
+    int renderedWidth = 0;
+
+    if (frameBufferBPP == BPP_16 && ditherMatrixSize != DITHER_NONE)
+    {
+        // 순서 디더링은 화면 픽셀마다 보정값이 다르므로 확대 중에도 픽셀을 복제하지 않고 열마다 변환한다.
+        renderedWidth = ditherViewportRowToBGR16((unsigned short *)pDestination, pPixelRow, imageWidth, pColorLUT, pViewport, screenX, screenY, width);
+    }
+    else if (pViewport->zoomIn > 1)
+    {
+        // 화면 열에 대응하는 이미지 열을 한 번씩만 변환한 뒤 배율만큼 복제한다.
+        const int zoomIn = pViewport->zoomIn;
+        const int lastImageX = MIN(imageWidth - 1, pViewport->originX + (screenX + width - 1) / zoomIn);
+        int screenColumn = screenX;
+
+        for (int imageX = pViewport->originX + screenX / zoomIn; imageX <= lastImageX; imageX++)
+        {
+            const RGBpixel imagePixel = pPixelRow[imageX];
+            const unsigned int pixel = pColorLUT->blue[imagePixel.blue] | pColorLUT->green[imagePixel.green] | pColorLUT->red[imagePixel.red];
+
+            const int runEnd = MIN(screenX + width, (imageX - pViewport->originX + 1) * zoomIn);
+            fillFrameBufferPixels(pDestination + (screenColumn - screenX) * bytesPerPixel, pixel, runEnd - screenColumn);
+            screenColumn = runEnd;
+        }
+        renderedWidth = screenColumn - screenX;
+    }
+    else if (pViewport->zoomOut > 1)
+    {
+        // zoomOut 간격으로 이미지 픽셀을 건너뛰며 변환한다.
+        const int zoomOut = pViewport->zoomOut;
+        const int firstImageX = pViewport->originX + screenX * zoomOut;
+        renderedWidth = thresholding((imageWidth - firstImageX + zoomOut - 1) / zoomOut, 0, width);
+
+        convertSampledRowToFrameBuffer(pDestination, &pPixelRow[firstImageX], renderedWidth, zoomOut, pColorLUT);
+    }
+    else
+    {
+        // 원본 크기는 행을 그대로 변환한다.
+        const int firstImageX = pViewport->originX + screenX;
+        renderedWidth = thresholding(imageWidth - firstImageX, 0, width);
+        convertRowToFrameBuffer(pDestination, &pPixelRow[firstImageX], renderedWidth, pColorLUT);
+    }
+
+    // 이미지 밖의 영역은 검은색으로 채운다.
+    memset(pDestination + renderedWidth * bytesPerPixel, 0, (width - renderedWidth) * bytesPerPixel);
+}
+
+// 프레임 버퍼의 사각형 영역에만 이미지를 출력한다. 이미지 밖의 영역은 검은색으로 채운다. (pBitmapHeader가 NULL이면 전부 검은색)
+// 영역을 띠 단위로 변환한 뒤 화면 회전에 맞게 프레임 버퍼로 옮긴다.
+// 0, 180도는 영역 너비의 한 행씩 바로 옮기고, 90, 270도는 캐시에 들어가는 ROTATION_BAND_HEIGHT * ROTATION_BAND_HEIGHT 크기의
+// 정사각형 띠(32BPP에서 64KB)를 모아서 전치한다.
+void drawImageRegionOnFrameBuffer(
     unsigned int *pfbmap,
     const struct fb_var_screeninfo fbvar,
     BMPHeader *pBitmapHeader,
     RGBpixel **pBitmapPixel2dArray,
-    const int brightness)
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport,
+    const int regionX,
+    const int regionY,
+    const int regionWidth,
+    const int regionHeight)
 {
-    // 이미지 크기가 화면 밖을 벗어나는 경우에 대비해
-    // 화면과 이미지 중 더 작은 너비, 높이 값을 사용한다.
-    const int minHeight = MIN(fbvar.yres_virtual, pBitmapHeader->biHeight);
-    const int minWidth = MIN(fbvar.xres_virtual, pBitmapHeader->biWidth);
+    const int bytesPerPixel = frameBufferBPP / 8;
+    if (regionWidth <= 0 || regionHeight <= 0)
+    {
+        return;
+    }
+
+    // 변환한 행을 담아둘 띠. 확대 중에는 같은 이미지 행이 여러 화면 행에 반복되므로 한 번만 변환하고 복사한다.
+    const bool isTransposed = (displayRotation == ROTATION_90 || displayRotation == ROTATION_270);
+    const int maxBandWidth = isTransposed ? MIN(regionWidth, ROTATION_BAND_HEIGHT) : regionWidth;
+    const int maxBandHeight = isTransposed ? ROTATION_BAND_HEIGHT : 1;
+    const int bandStride = maxBandWidth * bytesPerPixel;
+    unsigned char *pBandBuffer = (unsigned char *)allocatePoolBuffer(bandStride * maxBandHeight);
 
-    // 프레임 버퍼를 탐색한다.
-    for (int rowIndex = 0; rowIndex < minHeight; rowIndex++)
+    // 순서 디더링은 화면 행마다 무늬가 다르므로 같은 이미지 행이라도 다시 변환한다.
+    const bool isRowReusable = !(frameBufferBPP == BPP_16 && ditherMatrixSize != DITHER_NONE);
+
+    for (int bandY = regionY; bandY < regionY + regionHeight; bandY += maxBandHeight)
     {
-        for (int columnIndex = 0; columnIndex < minWidth; columnIndex++)
+        const int bandHeight = MIN(maxBandHeight, regionY + regionHeight - bandY);
+
+        for (int bandX = regionX; bandX < regionX + regionWidth; bandX += maxBandWidth)
         {
-            // 밝기 조절 기능에 의해 변경된 밝기 값을 반영한다.
-            RGBpixel pixelRGB = changePixelBrightness(pBitmapPixel2dArray[rowIndex][columnIndex], brightness);
+            const int bandWidth = MIN(maxBandWidth, regionX + regionWidth - bandX);
+            const unsigned char *pRenderedRow = NULL;
+            int renderedImageY = -1;
 
-            // 현재 탐색중인 프레임 버퍼 위치 : 프레임 버퍼 너비 * 행 번호 + 열 번호
-            int offset = fbvar.xres_virtual * rowIndex + columnIndex;
+            for (int bandRow = 0; bandRow < bandHeight; bandRow++)
+            {
+                // 현재 화면 행에 대응하는 이미지 행
+                const int imageY = pViewport->originY + (bandY + bandRow) * pViewport->zoomOut / pViewport->zoomIn;
+                unsigned char *pBandRow = pBandBuffer + bandStride * bandRow;
+
+                if (!pBitmapHeader || imageY >= pBitmapHeader->biHeight)
+                {
+                    memset(pBandRow, 0, bandWidth * bytesPerPixel);
+                    renderedImageY = -1;
+                }
+                else if (imageY == renderedImageY && isRowReusable)
+                {
+                    if (pBandRow != pRenderedRow)
+                    {
+                        memcpy(pBandRow, pRenderedRow, bandWidth * bytesPerPixel);
+                    }
+                }
+                else
+                {
+                    renderViewportRow(pBandRow, pBitmapPixel2dArray[imageY], pBitmapHeader->biWidth, pColorLUT, pViewport, bandX, bandY + bandRow, bandWidth);
+                    renderedImageY = imageY;
+                }
+                pRenderedRow = pBandRow;
+            }
 
-            // 24BPP인 기존 비트맵 이미지를 설정한 BPP에 맞게 프레임 버퍼에 출력한다.
-            *(pfbmap + offset) = (frameBufferBPP == BPP_16) ? convertRGB24toBGR16(pixelRGB) : convertRGB24toABGR32(pixelRGB);
+            // 띠가 캐시에 있는 동안 레이어를 합성하고 프레임 버퍼로 옮긴다.
+            blendOverlayLayers(pBandBuffer, bandStride, bandX, bandY, bandWidth, bandHeight);
+            blitRegionToFrameBuffer(pfbmap, fbvar, pBandBuffer, bandStride, bandX, bandY, bandWidth, bandHeight);
         }
     }
+
+    releasePoolBuffer(pBandBuffer);
+}
+
+// 프레임 버퍼에 이미지 출력
+void drawImageOnFrameBuffer(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    BMPHeader *pBitmapHeader,
+    RGBpixel **pBitmapPixel2dArray,
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport)
+{
+    drawImageRegionOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, pColorLUT, pViewport,
+        0, 0, getScreenWidth(fbvar), getScreenHeight(fbvar));
+}
+
+// 프레임 버퍼의 내용을 (deltaX, deltaY)만큼 옮긴다. 화면 밖으로 나간 부분은 버려진다.
+static void scrollFrameBuffer(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    const int deltaX,
+    const int deltaY)
+{
+    const int lineLength = calculateFrameBufferLineLength(fbvar);
+    const int bytesPerPixel = frameBufferBPP / 8;
+    const int screenHeight = fbvar.yres_virtual;
+    const int copyBytes = (fbvar.xres_virtual - abs(deltaX)) * bytesPerPixel;
+    const int sourceColumnBytes = MAX(0, -deltaX) * bytesPerPixel;
+    const int destinationColumnBytes = MAX(0, deltaX) * bytesPerPixel;
+
+    // 아래로 옮길 때는 아래쪽 행부터 옮겨야 아직 옮기지 않은 행을 덮어쓰지 않는다.
+    for (int rowCount = 0; rowCount < screenHeight - abs(deltaY); rowCount++)
+    {
+        const int destinationRow = (deltaY > 0) ? screenHeight - 1 - rowCount : rowCount;
+        const int sourceRow = destinationRow - deltaY;
+
+        memmove((unsigned char *)pfbmap + lineLength * destinationRow + destinationColumnBytes,
+            (unsigned char *)pfbmap + lineLength * sourceRow + sourceColumnBytes,
+            copyBytes);
+    }
+}
+
+// 화면을 상하좌우로 이동한다. 이미 출력된 부분은 옮기기만 하고 새로 드러난 부분만 다시 그린다.
+void panImageOnFrameBuffer(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    BMPHeader *pBitmapHeader,
+    RGBpixel **pBitmapPixel2dArray,
+    const ColorLUT *pColorLUT,
+    Viewport *pViewport,
+    const int panCommand)
+{
+    const int screenWidth = getScreenWidth(fbvar);
+    const int screenHeight = getScreenHeight(fbvar);
+
+    // 화면 크기의 1/PAN_STEP_DIVISOR를 이미지 픽셀 단위로 바꾼다. 축소 중에는 축소 배율의 배수로 맞춘다.
+    const int zoomOut = pViewport->zoomOut;
+    int stepX = (screenWidth / PAN_STEP_DIVISOR) * zoomOut / pViewport->zoomIn;
+    int stepY = (screenHeight / PAN_STEP_DIVISOR) * zoomOut / pViewport->zoomIn;
+    stepX = MAX(zoomOut, stepX - stepX % zoomOut);
+    stepY = MAX(zoomOut, stepY - stepY % zoomOut);
+
+    const int previousOriginX = pViewport->originX;
+    const int previousOriginY = pViewport->originY;
+    switch (panCommand)
+    {
+        case COMMAND_PAN_UP: pViewport->originY -= stepY; break;
+        case COMMAND_PAN_DOWN: pViewport->originY += stepY; break;
+        case COMMAND_PAN_LEFT: pViewport->originX -= stepX; break;
+        case COMMAND_PAN_RIGHT: pViewport->originX += stepX; break;
+    }
+    clampViewport(pViewport, fbvar, pBitmapHeader);
+
+    // 이미지가 움직인 만큼 화면 픽셀 단위로 바꾼다. (화면 내용은 시점과 반대 방향으로 움직인다.)
+    const int deltaX = (previousOriginX - pViewport->originX) * pViewport->zoomIn / zoomOut;
+    const int deltaY = (previousOriginY - pViewport->originY) * pViewport->zoomIn / zoomOut;
+
+    if (deltaX == 0 && deltaY == 0)
+    {
+        return;
+    }
+
+    // 한 화면 이상 움직였다면 남길 부분이 없으므로 전체를 다시 그린다.
+    if (abs(deltaX) >= screenWidth || abs(deltaY) >= screenHeight)
+    {
+        drawImageOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, pColorLUT, pViewport);
+        return;
+    }
+
+    // 화면 좌표의 이동량을 회전된 프레임 버퍼 좌표의 이동량으로 바꿔서 옮긴다.
+    switch (displayRotation)
+    {
+        case ROTATION_90: scrollFrameBuffer(pfbmap, fbvar, -deltaY, deltaX); break;
+        case ROTATION_180: scrollFrameBuffer(pfbmap, fbvar, -deltaX, -deltaY); break;
+        case ROTATION_270: scrollFrameBuffer(pfbmap, fbvar, deltaY, -deltaX); break;
+        default: scrollFrameBuffer(pfbmap, fbvar, deltaX, deltaY); break;
+    }
+
+    // 새로 드러난 가로 띠(위 또는 아래)와 세로 띠(왼쪽 또는 오른쪽)만 그린다.
+    const int stripY = (deltaY > 0) ? 0 : screenHeight + deltaY;
+    const int stripX = (deltaX > 0) ? 0 : screenWidth + deltaX;
+    const int keptY = (deltaY > 0) ? deltaY : 0;
+
+    drawImageRegionOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, pColorLUT, pViewport,
+        0, stripY, screenWidth, abs(deltaY));
+    drawImageRegionOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, pColorLUT, pViewport,
+        stripX, keptY, abs(deltaX), screenHeight - abs(deltaY));
+
+    // 레이어도 함께 옮겨졌으므로 옮겨진 자국을 지우고 제자리에 다시 합성한다.
+    scrollOverlayLayers(deltaX, deltaY);
+    compositeOverlayLayers(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, pColorLUT, pViewport);
+}
+
+// 캡처 파일 쓰기가 끝나면 파일을 닫고 메모리를 해제한다.
+static void completeCaptureWrite(AsyncIORequest *pRequest)
+{
+    if (pRequest->result < 0 || pRequest->result < pRequest->length)
+    {
+        errno = (pRequest->result < 0) ? -pRequest->result : EIO;
+        perror("Failed to write bitmap pixel.");
+    }
+
+    close(pRequest->fd);
+    releasePoolBuffer(pRequest->pBuffer);
+    free(pRequest);
 }
 
 // 프레임 버퍼에서 이미지를 읽어와 24BPP 비트맵 파일에 저장한다.
+// 헤더와 픽셀을 메모리에 모두 만든 뒤 한 번의 비동기 쓰기로 저장하므로 쓰기를 기다리지 않고 돌아온다.
 void captureFrameBuffer(
     unsigned int *pfbmap,
     const struct fb_var_screeninfo fbvar, 
@@ -196,78 +970,87 @@ void captureFrameBuffer(
         exit(1);
     }
 
-    // 비트맵 헤더 복사
-    BMPHeader *pBitmapOutputHeader = (BMPHeader*)malloc(BITMAP_HEADER_SIZE);
-    memcpy(pBitmapOutputHeader, pBitmapHeader, BITMAP_HEADER_SIZE);
-
     // 이미지 크기가 화면 밖을 벗어나는 경우
-    // 화면 크기에 맞게 이미지를 자르기 위해 비트맵 헤더를 수정한다.
-    const int minHeight = MIN(fbvar.yres_virtual, pBitmapHeader->biHeight);
-    const int minWidth = MIN(fbvar.xres_virtual, pBitmapHeader->biWidth);
+    // 화면 크기에 맞게 이미지를 자른다.
+    // 비트맵 너비가 4의 배수가 아닐 경우 4의 배수를 채우기 위해 행마다 패딩 바이트가 들어간다.
+    const int minHeight = MIN(getScreenHeight(fbvar), pBitmapHeader->biHeight);
+    const int minWidth = MIN(getScreenWidth(fbvar), pBitmapHeader->biWidth);
+    const int fileRowBytes = minWidth * (BITMAP_DEFAULT_BPP / 8) + minWidth % 4;
+    const int fileBytes = BITMAP_HEADER_SIZE + fileRowBytes * minHeight;
 
-    pBitmapOutputHeader->bfSize = minWidth * minHeight * (BITMAP_DEFAULT_BPP / 8) + BITMAP_HEADER_SIZE;  // 파일 크기
-    pBitmapOutputHeader->biSizeImage = minWidth * minHeight * (BITMAP_DEFAULT_BPP / 8);                  // 비트맵 이미지의 픽셀 데이터 크기
+    // 파일 전체를 담을 메모리. 버퍼 풀의 블록은 이전 내용이 남아 있으므로 패딩 바이트를 위해 0으로 채운다.
+    unsigned char *pFileBuffer = (unsigned char *)allocatePoolBuffer(fileBytes);
+    memset(pFileBuffer, 0, fileBytes);
+
+    // 비트맵 헤더 복사 후 잘라낸 크기에 맞게 수정한다.
+    BMPHeader *pBitmapOutputHeader = (BMPHeader *)pFileBuffer;
+    memcpy(pBitmapOutputHeader, pBitmapHeader, BITMAP_HEADER_SIZE);
+
+    pBitmapOutputHeader->bfSize = fileBytes;                                             // 파일 크기
+    pBitmapOutputHeader->bfOffBits = BITMAP_HEADER_SIZE;                                 // 픽셀 데이터의 시작 위치
+    pBitmapOutputHeader->biSizeImage = fileRowBytes * minHeight;                         // 비트맵 이미지의 픽셀 데이터 크기
     pBitmapOutputHeader->biWidth = minWidth;                                             // 비트맵 이미지의 가로 크기
     pBitmapOutputHeader->biHeight = minHeight;                                           // 비트맵 이미지의 세로 크기
     pBitmapOutputHeader->biBitCount = BITMAP_DEFAULT_BPP;                                // BPP(Bits Per Pixel)
 
-    // 비트맵 헤더를 파일에 쓴다.
-    int writeBytes = write(fdBitmapOutput, pBitmapOutputHeader, sizeof(BMPHeader));
-    if (writeBytes < 0)
-    {
-        perror("Failed to write bitmap header.");
-        exit(1);
-    }
-
-    // 동적 할당된 비트맵 헤더 메모리 해제
-    free(pBitmapOutputHeader);
-    
-    // 프레임 버퍼 탐색
+    // 프레임 버퍼 탐색. 비트맵은 아래 행부터 저장한다.
+    unsigned char *pFileRow = pFileBuffer + BITMAP_HEADER_SIZE;
     for (int rowIndex = minHeight - 1; rowIndex >= 0; rowIndex--)
     {
         for (int columnIndex = 0; columnIndex < minWidth; columnIndex++)
         {
-            // 현재 탐색중인 프레임 버퍼 위치 : 프레임 버퍼 너비 * 행 번호 + 열 번호
-            unsigned int *pFrameBufferIndex = pfbmap + (fbvar.xres_virtual * rowIndex) + columnIndex;
+            // 현재 탐색중인 프레임 버퍼 위치 : 화면 회전을 반영한 픽셀 위치
+            const int offset = calculateFrameBufferPixelOffset(fbvar, columnIndex, rowIndex);
 
             // 픽셀 값을 읽어온다.
-            unsigned int fixelRGBValue = *pFrameBufferIndex;
-
             // 16BPP 프레임 버퍼를 캡처할 경우 24BPP 이미지로 픽셀을 확장한다.
-            if (frameBufferBPP == BPP_16)
-            {
-                fixelRGBValue = convertBGR16toBGR24(fixelRGBValue);
-            }
+            const unsigned int fixelRGBValue = (frameBufferBPP == BPP_16)
+                ? convertBGR16toBGR24(*((unsigned short *)pfbmap + offset))
+                : *(pfbmap + offset);
 
-            // 읽어온 픽셀 값을 24BPP 비트맵 파일에 저장한다.
-            writeBytes = write(fdBitmapOutput, &fixelRGBValue, BITMAP_DEFAULT_BPP / 8);
-            if (writeBytes < 0)
-            {
-                perror("Failed to write bitmap pixel.");
-                exit(1);
-            }
+            // 읽어온 픽셀 값의 하위 3바이트(B, G, R)를 저장한다.
+            memcpy(pFileRow + columnIndex * (BITMAP_DEFAULT_BPP / 8), &fixelRGBValue, BITMAP_DEFAULT_BPP / 8);
         }
+        pFileRow += fileRowBytes;
+    }
 
-        // 비트맵 너비가 4의 배수가 아닐 경우 4의 배수를 채우기 위해 패딩 바이트가 들어간다.
-        int paddingBytes = pBitmapHeader->biWidth % 4;
-        while (paddingBytes > 0)
-        {
-            // 패딩 바이트를 비트맵 파일에 저장한다.
-            unsigned char padByte = 0;
-            writeBytes = write(fdBitmapOutput, &padByte, sizeof(unsigned char));
-            if (writeBytes < 0)
-            {
-                perror("Failed to write bitmap pixel.");
-                exit(1);
-            }
-            paddingBytes--;
-        }
+    // 파일 쓰기는 비동기로 맡긴다. 파일 닫기와 메모리 해제는 완료 함수가 한다.
+    AsyncIORequest *pWriteRequest = (AsyncIORequest *)calloc(1, sizeof(AsyncIORequest));
+    pWriteRequest->operation = ASYNC_IO_WRITE;
+    pWriteRequest->fd = fdBitmapOutput;
+    pWriteRequest->pBuffer = pFileBuffer;
+    pWriteRequest->length = fileBytes;
+    pWriteRequest->offset = 0;
+    pWriteRequest->pCompletionCallback = completeCaptureWrite;
+    submitAsyncIO(pWriteRequest);
+}
+
+// 메모리 내용의 체크섬 (FNV-1a 64비트)
+unsigned long long calculateChecksum(
+    const void *pData,
+    const size_t size)
+{
+    const unsigned char *pBytes = (const unsigned char *)pData;
+    unsigned long long checksum = 14695981039346656037ULL;
+
+    for (size_t byteIndex = 0; byteIndex < size; byteIndex++)
+    {
+        checksum = (checksum ^ pBytes[byteIndex]) * 1099511628211ULL;
     }
 
-    close(fdBitmapOutput);
+    return checksum;
+}
+
+// 프레임 버퍼 내용의 체크섬 (FNV-1a 64비트). 재생 결과를 비교하는 데 사용한다.
+unsigned long long calculateFrameBufferChecksum(
+    const unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar)
+{
+    return calculateChecksum(pfbmap, calculateFrameBufferSize(fbvar));
 }
 
 // 비트맵 파일의 헤더와 이미지를 읽고 동적 할당하여 매개변수로 포인터를 전달한다.
+// 행 묶음 단위로 읽는 loadBitmapImageProgressive를 출력 없이 사용한다.
 void loadBitmapImage(
     const unsigned int *pfbmap,
     const struct fb_var_screeninfo fbvar, 
@@ -275,72 +1058,113 @@ void loadBitmapImage(
     RGBpixel ***pReturnBitmapPixel2dArray,
     const char *pFileName)
 {
-    // 이미지 파일 열기
-    const int fdBitmapInput = open(pFileName, O_RDWR);
-    if (fdBitmapInput < 0)
+    loadBitmapImageProgressive(NULL, fbvar, pReturnBitmapHeader, pReturnBitmapPixel2dArray, pFileName, NULL, NULL, NULL);
+}
+
+// 뷰어가 읽을 수 있는 비트맵인지 헤더와 파일 크기로 확인한다.
+// loadBitmapImage는 실패하면 프로그램을 종료하므로 열기 전에 확인해서 지원하지 않는 파일은 건너뛴다.
+bool isSupportedBitmapHeader(
+    const BMPHeader *pBitmapHeader,
+    const long long fileSize)
+{
+    return pBitmapHeader->bfType == 0x4D42
+        && pBitmapHeader->biBitCount == BITMAP_DEFAULT_BPP
+        && pBitmapHeader->biWidth > 0
+        && pBitmapHeader->biHeight > 0
+        && fileSize >= BITMAP_HEADER_SIZE + (long long)(pBitmapHeader->biWidth * 3 + pBitmapHeader->biWidth % 4) * pBitmapHeader->biHeight;
+}
+
+// 읽어온 이미지가 있는지 확인한다.
+bool isImageLoaded(BMPHeader *pBitmapHeader, RGBpixel **pBitmapPixel2dArray)
+{
+    return pBitmapHeader && pBitmapPixel2dArray;
+}
+
+// loadBitmapImage로 버퍼 풀에서 빌린 비트맵 헤더와 이미지를 돌려준다.
+void freeBitmapImage(
+    BMPHeader *pBitmapHeader,
+    RGBpixel **pBitmapPixel2dArray)
+{
+    if (!isImageLoaded(pBitmapHeader, pBitmapPixel2dArray))
     {
-        perror("Failed to open image file.");
-        exit(1);
+        return;
     }
 
-    // 비트맵 헤더를 저장할 공간을 동적 할당 (54 Bytes)
-    BMPHeader *pBitmapHeader = (BMPHeader*)malloc(BITMAP_HEADER_SIZE);
+    // 헤더, 행 포인터 배열, 행들이 버퍼 풀의 블록 하나에 들어 있다.
+    releasePoolBuffer(pBitmapHeader);
+}
 
-    // 비트맵 헤더 읽기
-    int readBytes = read(fdBitmapInput, pBitmapHeader, BITMAP_HEADER_SIZE);
-    if (readBytes < 0)
+// 명령행 인자가 지정한 옵션이면 '=' 뒤의 값을, 아니면 NULL을 반환한다.
+const char *matchCommandLineOption(
+    const char *pArgument,
+    const char *pOptionName)
+{
+    const size_t optionNameLength = strlen(pOptionName);
+    if (strncmp(pArgument, pOptionName, optionNameLength))
     {
-        perror("Failed to read bitmap header.");
-        exit(1);
+        return NULL;
     }
-    
-    // 비트맵 이미지를 저장할 공간을 동적 할당 (헤더 54 Bytes를 제외한 나머지 크기)
-    RGBpixel **pBitmapPixel2dArray = (RGBpixel**)malloc(pBitmapHeader->biWidth * pBitmapHeader->biHeight);
 
-    // 비트맵 이미지는 위아래가 뒤집어져 있으므로 역순으로 읽는다.
-    for (int rowIndex = pBitmapHeader->biHeight-1; rowIndex >= 0; rowIndex--)
+    // 옵션 이름만 있고 값이 없으면(예: --gamma) 빈 문자열을 반환한다.
+    if (pArgument[optionNameLength] == '=')
     {
-        // 배열을 사용하기 위해 각 행마다 다시 동적 할당한다. (가로 픽셀 수 * 픽셀 바이트 크기)
-        pBitmapPixel2dArray[rowIndex] = (RGBpixel*)malloc(sizeof(RGBpixel) * pBitmapHeader->biWidth);
+        return pArgument + optionNameLength + 1;
+    }
+    return (pArgument[optionNameLength] == '\0') ? pArgument + optionNameLength : NULL;
+}
 
-        for (int columnIndex = 0; columnIndex < pBitmapHeader->biWidth; columnIndex++)
-        {
-            // 비트맵 픽셀 크기만큼 이미지를 읽는다.
-            readBytes = read(fdBitmapInput, &pBitmapPixel2dArray[rowIndex][columnIndex], sizeof(RGBpixel));
-            if (readBytes < 0)
-            {
-                perror("Failed to read bitmap pixel.");
-                exit(1);
-            }
-        }
-        
-        // 비트맵 너비가 4의 배수가 아닐 경우 4의 배수를 채우기 위해 패딩 바이트가 들어간다.
-        int paddingBytes = pBitmapHeader->biWidth % 4;
-        while (paddingBytes > 0)
-        {
-            // 패딩 바이트를 버린다.
-            unsigned char trashcan = ' ';
-            readBytes = read(fdBitmapInput, &trashcan, 1);
-            if (readBytes < 0)
-            {
-                perror("Failed to read padded bitmap pixel.");
-                exit(1);
-            }
-            paddingBytes--;
-        }
+// 콘솔에서 한 줄을 읽어 명령으로 바꾼다. 숫자는 버튼 번호, w/a/s/d는 이동, +/-는 확대/축소이다.
+int readConsoleCommand()
+{
+    // 입력이 끝나면(파이프로 넣은 입력 등) 프로그램을 종료한다.
+    char consoleBuffer[FILE_NAME_MAX_LENGTH] = {0};
+    if (!fgets(consoleBuffer, sizeof(consoleBuffer), stdin))
+    {
+        quit = 1;
+        return 0;
     }
 
-    // 동적 할당한 주소를 넘겨준다.
-    *pReturnBitmapHeader = pBitmapHeader;
-    *pReturnBitmapPixel2dArray = pBitmapPixel2dArray;
+    switch (consoleBuffer[0])
+    {
+        case 'w': return COMMAND_PAN_UP;
+        case 's': return COMMAND_PAN_DOWN;
+        case 'a': return COMMAND_PAN_LEFT;
+        case 'd': return COMMAND_PAN_RIGHT;
+        case 'o': return COMMAND_TOGGLE_OVERLAY;
+        case '+': return 7;
+        case '-': return 8;
+    }
 
-    close(fdBitmapInput);
+    // 숫자가 아닌 입력은 0(잘못된 번호)이 된다.
+    return atoi(consoleBuffer);
 }
 
-// 읽어온 이미지가 있는지 확인한다.
-bool isImageLoaded(BMPHeader *pBitmapHeader, RGBpixel **pBitmapPixel2dArray)
+// 다음 초가 시작될 때까지만 콘솔 입력을 기다린다. 입력이 들어왔으면 true를 반환한다.
+// 표준 입력의 버퍼에 남은 줄은 poll로 알 수 없으므로 이 함수를 사용할 때는 표준 입력을 버퍼 없이 사용한다.
+bool waitConsoleInputUntilNextSecond()
 {
-    return pBitmapHeader && pBitmapPixel2dArray;
+    struct timespec currentTime;
+    clock_gettime(CLOCK_REALTIME, &currentTime);
+    const int timeoutMilliseconds = 1000 - currentTime.tv_nsec / 1000000;
+
+    struct pollfd consolePoll = {STDIN_FILENO, POLLIN, 0};
+    return poll(&consolePoll, 1, timeoutMilliseconds) > 0;
+}
+
+// 이동 모드에서는 방향키 위치의 버튼(2, 4, 6, 8)을 이동 명령으로 바꾼다.
+//   1 [2] 3
+//  [4] 5 [6]
+//   7 [8] 9
+int translatePanModeCommand(const int pushSwitchValue)
+{
+    switch (pushSwitchValue)
+    {
+        case 2: return COMMAND_PAN_UP;
+        case 8: return COMMAND_PAN_DOWN;
+        case 4: return COMMAND_PAN_LEFT;
+        case 6: return COMMAND_PAN_RIGHT;
+    }
+    return pushSwitchValue;
 }
 
 // 프로그램 사용법을 콘솔에 출력한다.
@@ -353,5 +1177,9 @@ void printUsageOnConsole()
     printf("4 : Increase brightness\n");
     printf("5 : Decrease brightness\n");
     printf("6 : Capture frame buffer\n");
+    printf("7 (+) : Zoom in\n");
+    printf("8 (-) : Zoom out\n");
+    printf("9 : Toggle pan mode (2/8/4/6 or w/s/a/d : up/down/left/right)\n");
+    printf("o : Toggle overlays (console only)\n");
     printf("Ctrl + c : quit\n");
 }
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <linux/fb.h>
+#include <sys/stat.h>
+
+#include "fbbmp.h"
+
+// 디코딩한 프레임 하나를 담는 칸
+typedef struct playbackSlot
+{
+    unsigned int *pSurface;     // 프레임 버퍼 형식으로 변환한 화면
+    long long readySequence;    // 담겨 있는 프레임의 재생 순번 (없으면 -1)
+    bool isSkipped;             // 출력 시각이 지나 디코딩하지 않고 건너뛴 순번인지 여부
+} PlaybackSlot;
+
+// 디코딩 스레드와 출력(재생) 스레드가 공유하는 미리 디코딩 큐.
+// 재생 순번 n의 프레임은 n % slotCount 칸에 들어가며, n - slotCount 프레임을 출력하거나 버린 뒤에만 디코딩할 수 있다.
+typedef struct playbackQueue
+{
+    const char *pPattern;               // 파일명 형식 (예: frame%04d.bmp)
+    int firstFrameNumber;               // 첫 파일 번호
+    int frameCount;                     // 한 번 재생할 프레임 수
+    long long sequenceCount;            // 전체 재생 순번 수 (0이면 무한 반복)
+    struct fb_var_screeninfo fbvar;     // 변환할 프레임 버퍼 형식
+    const ColorLUT *pColorLUT;          // 색상 변환 테이블
+    PlaybackSlot *pSlotArray;           // 프레임 칸
+    int slotCount;                      // 프레임 칸 수
+    bool isCached;                      // 모든 프레임을 담을 수 있어 한 번만 디코딩하는지 여부
+    long long nextDecodeSequence;       // 다음에 디코딩할 재생 순번
+    long long presentedCount;           // 출력하거나 버린 프레임 수 (이보다 작은 순번의 칸은 다시 쓸 수 있다.)
+    bool isStopped;                     // 재생 종료 요청
+    long long startTime;                // 재생 순번 0의 출력 시각 (0이면 아직 시작하지 않았다.)
+    long long framePeriod;              // 프레임 간격 (나노초)
+    pthread_mutex_t mutex;
+    pthread_cond_t frameReadyCondition; // 프레임 디코딩 완료
+    pthread_cond_t slotFreeCondition;   // 칸 비워짐
+} PlaybackQueue;
+
+// 파일명 형식이 정수 변환(%d) 하나만 가지고 있는지 확인한다. (예: frame%04d.bmp)
+static bool isValidSequencePattern(const char *pPattern)
+{
+    const char *pConversion = strchr(pPattern, '%');
+    if (!pConversion)
+    {
+        return false;
+    }
+
+    const char *pConversionEnd = pConversion + 1;
+    while (isdigit((unsigned char)*pConversionEnd))
+    {
+        pConversionEnd++;
+    }
+    return *pConversionEnd == 'd' && !strchr(pConversionEnd, '%');
+}
+
+// 재생할 수 있는 비트맵 파일인지 헤더로 확인한다. 디코딩 스레드에서 실패하면 프로그램이 종료되므로 미리 확인한다.
+static bool isPlayableFrameFile(const char *pFileName)
+{
+    struct stat fileStatus;
+    BMPHeader bitmapHeader;
+    const int fdFrameInput = open(pFileName, O_RDONLY);
+    if (fdFrameInput < 0)
+    {
+        return false;
+    }
+
+    const bool isPlayable = fstat(fdFrameInput, &fileStatus) == 0
+        && read(fdFrameInput, &bitmapHeader, BITMAP_HEADER_SIZE) == BITMAP_HEADER_SIZE
+        && isSupportedBitmapHeader(&bitmapHeader, fileStatus.st_size);
+    close(fdFrameInput);
+    return isPlayable;
+}
+
+// 디코딩 스레드. 다음 재생 순번을 가져가 칸이 비기를 기다린 뒤 파일을 읽고 프레임 버퍼 형식으로 변환한다.
+// 모든 프레임을 담을 수 있다면 첫 번째 반복만 디코딩하고, 이후 반복은 칸에 남아있는 프레임을 그대로 출력한다.
+// 큐를 사용할 때 칸이 빈 시점에 이미 다음 프레임의 출력 시각까지 지났다면 디코딩하지 않고 건너뛰어 재생을 따라잡는다.
+static void *playbackDecoder(void *pArgument)
+{
+    PlaybackQueue *pQueue = (PlaybackQueue *)pArgument;
+    char frameFileName[FILE_PATH_MAX_LENGTH];
+    Viewport viewport;
+    initViewport(&viewport);
+
+    for (;;)
+    {
+        pthread_mutex_lock(&pQueue->mutex);
+        const long long sequence = pQueue->nextDecodeSequence;
+        if (pQueue->isStopped
+            || (pQueue->isCached && sequence >= pQueue->frameCount)
+            || (pQueue->sequenceCount && sequence >= pQueue->sequenceCount))
+        {
+            pthread_mutex_unlock(&pQueue->mutex);
+            break;
+        }
+        pQueue->nextDecodeSequence++;
+
+        while (!pQueue->isStopped && sequence >= pQueue->presentedCount + pQueue->slotCount)
+        {
+            pthread_cond_wait(&pQueue->slotFreeCondition, &pQueue->mutex);
+        }
+
+        if (pQueue->isStopped)
+        {
+            pthread_mutex_unlock(&pQueue->mutex);
+            break;
+        }
+
+        PlaybackSlot *pSlot = &pQueue->pSlotArray[sequence % pQueue->slotCount];
+        if (!pQueue->isCached && pQueue->startTime
+            && getMonotonicTime() >= pQueue->startTime + (sequence + 1) * pQueue->framePeriod)
+        {
+            pSlot->readySequence = sequence;
+            pSlot->isSkipped = true;
+            pthread_cond_broadcast(&pQueue->frameReadyCondition);
+            pthread_mutex_unlock(&pQueue->mutex);
+            continue;
+        }
+        pthread_mutex_unlock(&pQueue->mutex);
+
+        // 다른 스레드와 겹치지 않는 칸에 변환하므로 잠그지 않는다.
+        snprintf(frameFileName, sizeof(frameFileName), pQueue->pPattern, pQueue->firstFrameNumber + (int)(sequence % pQueue->frameCount));
+
+        BMPHeader *pBitmapHeader = NULL;
+        RGBpixel **pBitmapPixel2dArray = NULL;
+        loadBitmapImage(NULL, pQueue->fbvar, &pBitmapHeader, &pBitmapPixel2dArray, frameFileName);
+        drawImageOnFrameBuffer(pSlot->pSurface, pQueue->fbvar, pBitmapHeader, pBitmapPixel2dArray, pQueue->pColorLUT, &viewport);
+        freeBitmapImage(pBitmapHeader, pBitmapPixel2dArray);
+
+        pthread_mutex_lock(&pQueue->mutex);
+        pSlot->readySequence = sequence;
+        pSlot->isSkipped = false;
+        pthread_cond_broadcast(&pQueue->frameReadyCondition);
+        pthread_mutex_unlock(&pQueue->mutex);
+    }
+
+    return NULL;
+}
+
+// 재생 순번의 프레임이 칸에 준비되었는지 확인한다. 잠근 상태에서 호출한다.
+static bool isPlaybackFrameReady(
+    const PlaybackQueue *pQueue,
+    const long long sequence)
+{
+    const long long expectedSequence = pQueue->isCached ? sequence % pQueue->frameCount : sequence;
+    return pQueue->pSlotArray[sequence % pQueue->slotCount].readySequence == expectedSequence;
+}
+
+// 번호가 붙은 비트맵 파일들(pPattern, 0 또는 1번부터 연속된 번호)을 지정한 fps로 반복 재생한다.
+// 여러 디코딩 스레드가 제한된 크기의 큐에 미리 디코딩해두고, 출력은 단조 증가 시계의 일정한 간격에 맞춘다.
+// 늦은 프레임은 다음 프레임이 이미 준비되어 있을 때만 버리고, 아니면 늦게라도 출력해서 화면이 멈추지 않게 한다.
+// 디코딩이 목표 fps보다 느리면 디코딩 스레드가 출력 시각이 지난 순번을 건너뛰므로 디코딩 속도만큼은 계속 출력된다.
+// 전체 프레임이 메모리 한도 안에 들어가면 첫 번째 반복 이후에는 파일을 다시 읽지 않는다.
+void playImageSequence(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    const char *pPattern,
+    const int framesPerSecond,
+    const int loopCount,
+    const int decoderCount,
+    const long long memoryBudget,
+    const ColorLUT *pColorLUT)
+{
+    if (!isValidSequencePattern(pPattern))
+    {
+        printf("Invalid sequence pattern - ex) --play=frame%%04d.bmp\n");
+        return;
+    }
+
+    // 첫 파일 번호(0 또는 1)부터 연속으로 있는 파일 수를 센다.
+    PlaybackQueue queue = {0};
+    char frameFileName[FILE_PATH_MAX_LENGTH];
+    snprintf(frameFileName, sizeof(frameFileName), pPattern, 0);
+    queue.firstFrameNumber = (access(frameFileName, F_OK) == 0) ? 0 : 1;
+    for (;;)
+    {
+        snprintf(frameFileName, sizeof(frameFileName), pPattern, queue.firstFrameNumber + queue.frameCount);
+        if (!isPlayableFrameFile(frameFileName))
+        {
+            break;
+        }
+        queue.frameCount++;
+    }
+    if (queue.frameCount == 0)
+    {
+        printf("There isn't any playable frame - %s\n", frameFileName);
+        return;
+    }
+
+    // 전체 프레임이 메모리 한도 안에 들어가면 모두 담아두고, 아니면 한도 안에서 최대 PLAYBACK_QUEUE_DEPTH 칸만 사용한다.
+    const int frameSize = calculateFrameBufferSize(fbvar);
+    queue.isCached = (long long)frameSize * queue.frameCount <= memoryBudget;
+    queue.slotCount = queue.isCached
+        ? queue.frameCount
+        : thresholding(MIN(memoryBudget / frameSize, PLAYBACK_QUEUE_DEPTH), 2, PLAYBACK_QUEUE_DEPTH);
+    queue.pSlotArray = (PlaybackSlot *)malloc(sizeof(PlaybackSlot) * queue.slotCount);
+    for (int slotIndex = 0; slotIndex < queue.slotCount; slotIndex++)
+    {
+        queue.pSlotArray[slotIndex].pSurface = (unsigned int *)allocatePoolBuffer(frameSize);
+        queue.pSlotArray[slotIndex].readySequence = -1;
+        queue.pSlotArray[slotIndex].isSkipped = false;
+    }
+
+    queue.pPattern = pPattern;
+    queue.sequenceCount = (long long)loopCount * queue.frameCount;
+    queue.fbvar = fbvar;
+    queue.pColorLUT = pColorLUT;
+    pthread_mutex_init(&queue.mutex, NULL);
+    pthread_cond_init(&queue.frameReadyCondition, NULL);
+    pthread_cond_init(&queue.slotFreeCondition, NULL);
+
+    const int threadCount = thresholding(decoderCount, 1, queue.isCached ? queue.frameCount : queue.slotCount);
+    pthread_t *pThreadArray = (pthread_t *)malloc(sizeof(pthread_t) * threadCount);
+    for (int threadIndex = 0; threadIndex < threadCount; threadIndex++)
+    {
+        pthread_create(&pThreadArray[threadIndex], NULL, playbackDecoder, &queue);
+    }
+
+    printf("Play : %s, %d frames from %d, %d fps, %d decoders, %s %d frames (%d MB)\n",
+        pPattern, queue.frameCount, queue.firstFrameNumber, framesPerSecond, threadCount,
+        queue.isCached ? "cached" : "queue", queue.slotCount, (int)((long long)frameSize * queue.slotCount >> 20));
+
+    // 큐가 찰 때까지(최대 PLAYBACK_QUEUE_DEPTH) 기다린 뒤 재생 시각을 정한다. 시작하자마자 프레임을 버리지 않도록 한다.
+    const int prerollCount = MIN(MIN(queue.slotCount, queue.frameCount), PLAYBACK_QUEUE_DEPTH);
+    pthread_mutex_lock(&queue.mutex);
+    for (int prerollIndex = 0; prerollIndex < prerollCount && !quit; prerollIndex++)
+    {
+        while (!isPlaybackFrameReady(&queue, prerollIndex))
+        {
+            pthread_cond_wait(&queue.frameReadyCondition, &queue.mutex);
+        }
+    }
+    const long long framePeriod = 1000000000LL / framesPerSecond;
+    const long long startTime = getMonotonicTime();
+    queue.framePeriod = framePeriod;
+    queue.startTime = startTime;
+    pthread_mutex_unlock(&queue.mutex);
+
+    long long reportTime = startTime;
+    int reportPresentedCount = 0;
+    int presentedFrameCount = 0;
+    int droppedFrameCount = 0;
+    int reportDroppedCount = 0;
+    long long sequence = 0;
+
+    for (sequence = 0; !quit && (!queue.sequenceCount || sequence < queue.sequenceCount); sequence++)
+    {
+        PlaybackSlot *pSlot = &queue.pSlotArray[sequence % queue.slotCount];
+
+        pthread_mutex_lock(&queue.mutex);
+        while (!isPlaybackFrameReady(&queue, sequence))
+        {
+            pthread_cond_wait(&queue.frameReadyCondition, &queue.mutex);
+        }
+        const bool isSkipped = pSlot->isSkipped;
+        const PlaybackSlot *pNextSlot = &queue.pSlotArray[(sequence + 1) % queue.slotCount];
+        const bool isNextFrameReady = (!queue.sequenceCount || sequence + 1 < queue.sequenceCount)
+            && isPlaybackFrameReady(&queue, sequence + 1) && !pNextSlot->isSkipped;
+        pthread_mutex_unlock(&queue.mutex);
+
+        // 출력할 시각까지 기다렸다가 출력한다. 다음 프레임의 시각도 지났고 다음 프레임이 준비되어 있다면 버린다.
+        const long long dueTime = startTime + sequence * framePeriod;
+        if (isSkipped || (getMonotonicTime() >= dueTime + framePeriod && isNextFrameReady))
+        {
+            droppedFrameCount++;
+        }
+        else
+        {
+            const struct timespec wakeTime = {dueTime / 1000000000LL, dueTime % 1000000000LL};
+            // clock_nanosleep은 errno를 쓰지 않고 오류 번호를 반환한다. 시그널로 깬 경우(EINTR)에만 다시 잔다.
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, NULL) == EINTR)
+            {
+            }
+            memcpy(pfbmap, pSlot->pSurface, frameSize);
+            publishFrame(pfbmap);
+            presentedFrameCount++;
+        }
+
+        // 모두 담아두지 않았다면 칸을 비우고 디코딩 스레드를 깨운다.
+        int queueDepth = 0;
+        pthread_mutex_lock(&queue.mutex);
+        if (!queue.isCached)
+        {
+            queue.presentedCount = sequence + 1;
+            pthread_cond_broadcast(&queue.slotFreeCondition);
+        }
+        for (int slotIndex = 0; slotIndex < queue.slotCount; slotIndex++)
+        {
+            queueDepth += isPlaybackFrameReady(&queue, sequence + 1 + slotIndex) ? 1 : 0;
+        }
+        pthread_mutex_unlock(&queue.mutex);
+
+        // 1초마다 실제 fps, 큐에 준비된 프레임 수, 버린 프레임 수를 출력한다.
+        const long long now = getMonotonicTime();
+        if (now - reportTime >= PLAYBACK_REPORT_INTERVAL)
+        {
+            printf("PLAY : %.1f fps (target %d), queue %d/%d, dropped %d (total %d), loop %lld\n",
+                (double)(presentedFrameCount - reportPresentedCount) * 1000000000LL / (now - reportTime), framesPerSecond,
+                queueDepth, queue.slotCount, droppedFrameCount - reportDroppedCount, droppedFrameCount,
+                sequence / queue.frameCount + 1);
+            reportTime = now;
+            reportPresentedCount = presentedFrameCount;
+            reportDroppedCount = droppedFrameCount;
+        }
+    }
+
+    // 디코딩 스레드를 멈추고 정리한다.
+    pthread_mutex_lock(&queue.mutex);
+    queue.isStopped = true;
+    pthread_cond_broadcast(&queue.slotFreeCondition);
+    pthread_mutex_unlock(&queue.mutex);
+    for (int threadIndex = 0; threadIndex < threadCount; threadIndex++)
+    {
+        pthread_join(pThreadArray[threadIndex], NULL);
+    }
+    free(pThreadArray);
+
+    const long long elapsedTime = getMonotonicTime() - startTime;
+    printf("PLAY : %d presented, %d dropped, %.1f fps average (target %d), %lld loops\n",
+        presentedFrameCount, droppedFrameCount,
+        elapsedTime ? (double)presentedFrameCount * 1000000000LL / elapsedTime : 0.0, framesPerSecond,
+        sequence / queue.frameCount);
+
+    for (int slotIndex = 0; slotIndex < queue.slotCount; slotIndex++)
+    {
+        releasePoolBuffer(queue.pSlotArray[slotIndex].pSurface);
+    }
+    free(queue.pSlotArray);
+    pthread_cond_destroy(&queue.slotFreeCondition);
+    pthread_cond_destroy(&queue.frameReadyCondition);
+    pthread_mutex_destroy(&queue.mutex);
+}
@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <linux/fb.h>
+#include <dirent.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "fbbmp.h"
+
+// 미리 변환할 파일 목록과 다음에 처리할 파일 번호. 작업 스레드들이 공유한다.
+typedef struct prerenderJob
+{
+    char **pFilePathArray;              // 변환할 비트맵 파일 경로 목록
+    int fileCount;                      // 변환할 비트맵 파일 수
+    int nextFileIndex;                  // 다음에 가져갈 파일 번호 (원자적으로 증가시킨다.)
+    int failedFileCount;                // 변환에 실패한 파일 수 (원자적으로 증가시킨다.)
+    struct fb_var_screeninfo fbvar;     // 변환할 프레임 버퍼 형식
+} PrerenderJob;
+
+// 변환 결과에 영향을 주는 디더링 행렬 크기. 디더링은 16BPP에만 적용된다.
+static int getPrerenderDitherMatrixSize()
+{
+    return (frameBufferBPP == BPP_16) ? ditherMatrixSize : DITHER_NONE;
+}
+
+// 원본 파일명에 대응하는 미리 변환한 파일명을 만든다. (image.bmp -> image.fbraw)
+void makePrerenderFileName(
+    char *pPrerenderFileName,
+    const char *pSourceFileName)
+{
+    const char *pExtension = strrchr(pSourceFileName, '.');
+    const int baseNameLength = pExtension ? (int)(pExtension - pSourceFileName) : (int)strlen(pSourceFileName);
+
+    snprintf(pPrerenderFileName, FILE_PATH_MAX_LENGTH, "%.*s.%s", baseNameLength, pSourceFileName, PRERENDER_EXTENSION);
+}
+
+// 비트맵 파일 하나를 프레임 버퍼 형식으로 변환해 저장한다. 지원하지 않는 파일이면 false를 반환한다.
+bool prerenderImageFile(
+    const char *pSourceFileName,
+    const char *pPrerenderFileName,
+    const struct fb_var_screeninfo fbvar)
+{
+    // 헤더를 먼저 확인해 지원하지 않는 파일은 건너뛴다.
+    struct stat sourceStatus;
+    BMPHeader bitmapHeader;
+    const int fdBitmapInput = open(pSourceFileName, O_RDONLY);
+    if (fdBitmapInput < 0)
+    {
+        return false;
+    }
+    const bool isValidHeader = fstat(fdBitmapInput, &sourceStatus) == 0
+        && read(fdBitmapInput, &bitmapHeader, BITMAP_HEADER_SIZE) == BITMAP_HEADER_SIZE
+        && isSupportedBitmapHeader(&bitmapHeader, sourceStatus.st_size);
+    close(fdBitmapInput);
+
+    if (!isValidHeader)
+    {
+        return false;
+    }
+
+    // 뷰어와 같은 코드로 비트맵을 읽고 프레임 버퍼 형식으로 변환한다. (색상 조정 없음, 원본 크기, 좌상단 기준)
+    BMPHeader *pBitmapHeader = NULL;
+    RGBpixel **pBitmapPixel2dArray = NULL;
+    loadBitmapImage(NULL, fbvar, &pBitmapHeader, &pBitmapPixel2dArray, pSourceFileName);
+
+    ColorAdjustment colorAdjustment;
+    ColorLUT colorLUT;
+    Viewport viewport;
+    initColorAdjustment(&colorAdjustment);
+    buildColorLUT(&colorLUT, &colorAdjustment);
+    initViewport(&viewport);
+
+    PrerenderHeader prerenderHeader = {0};
+    prerenderHeader.magic = PRERENDER_MAGIC;
+    prerenderHeader.version = PRERENDER_VERSION;
+    prerenderHeader.headerSize = sizeof(PrerenderHeader);
+    prerenderHeader.width = fbvar.xres_virtual;
+    prerenderHeader.height = fbvar.yres_virtual;
+    prerenderHeader.stride = calculateFrameBufferLineLength(fbvar);
+    prerenderHeader.bitsPerPixel = frameBufferBPP;
+    prerenderHeader.rotation = displayRotation;
+    prerenderHeader.ditherMatrixSize = getPrerenderDitherMatrixSize();
+    prerenderHeader.sourceWidth = pBitmapHeader->biWidth;
+    prerenderHeader.sourceHeight = pBitmapHeader->biHeight;
+    prerenderHeader.sourceBitCount = pBitmapHeader->biBitCount;
+    prerenderHeader.sourceSize = sourceStatus.st_size;
+    prerenderHeader.sourceModifiedTime = getModifiedTime(&sourceStatus);
+
+    const int surfaceSize = calculateFrameBufferSize(fbvar);
+    unsigned int *pSurface = (unsigned int *)allocatePoolBuffer(surfaceSize);
+    drawImageOnFrameBuffer(pSurface, fbvar, pBitmapHeader, pBitmapPixel2dArray, &colorLUT, &viewport);
+    freeBitmapImage(pBitmapHeader, pBitmapPixel2dArray);
+
+    // 뷰어가 쓰다 만 파일을 읽지 않도록 임시 파일에 쓴 뒤 이름을 바꾼다.
+    char temporaryFileName[FILE_PATH_MAX_LENGTH];
+    snprintf(temporaryFileName, sizeof(temporaryFileName), "%s.tmp", pPrerenderFileName);
+
+    bool isWritten = false;
+    const int fdPrerenderOutput = open(temporaryFileName, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (fdPrerenderOutput >= 0)
+    {
+        isWritten = write(fdPrerenderOutput, &prerenderHeader, sizeof(PrerenderHeader)) == sizeof(PrerenderHeader)
+            && write(fdPrerenderOutput, pSurface, surfaceSize) == surfaceSize;
+        close(fdPrerenderOutput);
+    }
+    releasePoolBuffer(pSurface);
+
+    if (!isWritten || rename(temporaryFileName, pPrerenderFileName) < 0)
+    {
+        unlink(temporaryFileName);
+        return false;
+    }
+    return true;
+}
+
+// 작업 스레드. 남은 파일이 없을 때까지 파일을 하나씩 가져가 변환한다.
+static void *prerenderWorker(void *pArgument)
+{
+    PrerenderJob *pJob = (PrerenderJob *)pArgument;
+    char prerenderFileName[FILE_PATH_MAX_LENGTH];
+
+    for (;;)
+    {
+        const int fileIndex = __atomic_fetch_add(&pJob->nextFileIndex, 1, __ATOMIC_RELAXED);
+        if (fileIndex >= pJob->fileCount)
+        {
+            break;
+        }
+
+        const char *pSourceFileName = pJob->pFilePathArray[fileIndex];
+        makePrerenderFileName(prerenderFileName, pSourceFileName);
+
+        if (prerenderImageFile(pSourceFileName, prerenderFileName, pJob->fbvar))
+        {
+            printf("Prerendered : %s -> %s\n", pSourceFileName, prerenderFileName);
+        }
+        else
+        {
+            printf("Skipped : %s\n", pSourceFileName);
+            __atomic_fetch_add(&pJob->failedFileCount, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    return NULL;
+}
+
+// 경로 안의 모든 비트맵 파일을 여러 스레드로 나누어 미리 변환한다. 실패한 파일 수를 반환한다.
+int prerenderImagesInPath(
+    const char *pTargetPath,
+    const struct fb_var_screeninfo fbvar,
+    const int jobCount)
+{
+    // 디렉토리 열기
+    DIR *pDIR = opendir(pTargetPath);
+    if (!pDIR)
+    {
+        perror("Failed to open directory.");
+        exit(1);
+    }
+
+    // 뷰어와 달리 파일 수에 제한을 두지 않고 비트맵 파일 경로를 모두 수집한다.
+    PrerenderJob job = {0};
+    int filePathArrayCapacity = 0;
+    struct dirent *pDirent;
+    while ((pDirent = readdir(pDIR)))
+    {
+        const char *pCurrentExtension = strrchr(pDirent->d_name, '.');
+        if (!pCurrentExtension || strcmp(pCurrentExtension + 1, BITMAP_EXTENSION)) continue;
+
+        if (job.fileCount == filePathArrayCapacity)
+        {
+            filePathArrayCapacity = MAX(FILE_NAME_ARRAY_SIZE, filePathArrayCapacity * 2);
+            job.pFilePathArray = (char **)realloc(job.pFilePathArray, sizeof(char *) * filePathArrayCapacity);
+        }
+        job.pFilePathArray[job.fileCount] = (char *)malloc(FILE_PATH_MAX_LENGTH);
+        snprintf(job.pFilePathArray[job.fileCount], FILE_PATH_MAX_LENGTH, "%s/%s", pTargetPath, pDirent->d_name);
+        job.fileCount++;
+    }
+    closedir(pDIR);
+
+    // 작업 스레드를 만들고 모두 끝날 때까지 기다린다.
+    job.fbvar = fbvar;
+    const int threadCount = thresholding(jobCount, 1, MAX(1, job.fileCount));
+    pthread_t *pThreadArray = (pthread_t *)malloc(sizeof(pthread_t) * threadCount);
+    for (int threadIndex = 0; threadIndex < threadCount; threadIndex++)
+    {
+        pthread_create(&pThreadArray[threadIndex], NULL, prerenderWorker, &job);
+    }
+    for (int threadIndex = 0; threadIndex < threadCount; threadIndex++)
+    {
+        pthread_join(pThreadArray[threadIndex], NULL);
+    }
+    free(pThreadArray);
+
+    printf("Prerendered %d of %d files with %d threads (%dx%d, %d BPP, rotation %d)\n",
+        job.fileCount - job.failedFileCount, job.fileCount, threadCount, fbvar.xres_virtual, fbvar.yres_virtual, frameBufferBPP, displayRotation);
+
+    for (int fileIndex = 0; fileIndex < job.fileCount; fileIndex++)
+    {
+        free(job.pFilePathArray[fileIndex]);
+    }
+    free(job.pFilePathArray);
+
+    return job.failedFileCount;
+}
+
+// 원본보다 최신인 미리 변환한 파일이 있으면 프레임 버퍼에 그대로 복사하고 true를 반환한다.
+bool displayPrerenderedImage(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    const char *pSourceFileName,
+    PrerenderHeader *pReturnPrerenderHeader)
+{
+    char prerenderFileName[FILE_PATH_MAX_LENGTH];
+    makePrerenderFileName(prerenderFileName, pSourceFileName);
+
+    struct stat sourceStatus;
+    struct stat prerenderStatus;
+    if (stat(pSourceFileName, &sourceStatus) < 0 || stat(prerenderFileName, &prerenderStatus) < 0)
+    {
+        return false;
+    }
+
+    const int surfaceSize = calculateFrameBufferSize(fbvar);
+    if (prerenderStatus.st_size != (off_t)sizeof(PrerenderHeader) + surfaceSize)
+    {
+        return false;
+    }
+
+    const int fdPrerenderInput = open(prerenderFileName, O_RDONLY);
+    if (fdPrerenderInput < 0)
+    {
+        return false;
+    }
+    unsigned char *pPrerenderMap = (unsigned char *)mmap(0, prerenderStatus.st_size, PROT_READ, MAP_SHARED, fdPrerenderInput, 0);
+    close(fdPrerenderInput);
+    if (pPrerenderMap == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // 프레임 버퍼 형식과 원본 파일이 변환할 때와 같은 경우에만 사용한다.
+    const PrerenderHeader *pPrerenderHeader = (const PrerenderHeader *)pPrerenderMap;
+    const bool isUpToDate = pPrerenderHeader->magic == PRERENDER_MAGIC
+        && pPrerenderHeader->version == PRERENDER_VERSION
+        && pPrerenderHeader->headerSize == sizeof(PrerenderHeader)
+        && pPrerenderHeader->width == (int)fbvar.xres_virtual
+        && pPrerenderHeader->height == (int)fbvar.yres_virtual
+        && pPrerenderHeader->stride == calculateFrameBufferLineLength(fbvar)
+        && pPrerenderHeader->bitsPerPixel == frameBufferBPP
+        && pPrerenderHeader->rotation == displayRotation
+        && pPrerenderHeader->ditherMatrixSize == getPrerenderDitherMatrixSize()
+        && pPrerenderHeader->sourceSize == sourceStatus.st_size
+        && pPrerenderHeader->sourceModifiedTime == getModifiedTime(&sourceStatus);
+
+    // 변환 없이 한 번의 복사로 출력한다.
+    if (isUpToDate)
+    {
+        memcpy(pfbmap, pPrerenderMap + pPrerenderHeader->headerSize, surfaceSize);
+        *pReturnPrerenderHeader = *pPrerenderHeader;
+    }
+
+    munmap(pPrerenderMap, prerenderStatus.st_size);
+    return isUpToDate;
+}
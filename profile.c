@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <string.h>
+#include <linux/fb.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+
+#include "fbbmp.h"
+
+// 측정할 카운터의 종류와 출력 이름
+static const struct
+{
+    unsigned int type;
+    unsigned long long config;
+    const char *pName;
+} profileCounterArray[PROFILE_COUNTER_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache-misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch-misses"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "page-faults"},
+};
+
+static bool isProfilerEnabled = false;                      // --profile 지정 여부
+static int fdProfileCounterArray[PROFILE_COUNTER_COUNT];    // 카운터별 파일 디스크립터 (열 수 없으면 -1)
+static bool isKernelCountedArray[PROFILE_COUNTER_COUNT];    // 카운터별 커널 영역 포함 여부 (아니면 출력 이름 뒤에 perf처럼 :u를 붙인다.)
+
+// 카운터 값을 읽는다. 카운터가 여러 개라 커널이 번갈아 측정(멀티플렉싱)했다면 실제 측정 시간 비율로 보정한다.
+static long long readProfileCounter(const int fdCounter)
+{
+    unsigned long long valueArray[3];   // 값, 활성 시간, 실제 측정 시간
+    if (read(fdCounter, valueArray, sizeof(valueArray)) != sizeof(valueArray))
+    {
+        return 0;
+    }
+    if (valueArray[2] == 0)
+    {
+        return 0;
+    }
+    if (valueArray[2] < valueArray[1])
+    {
+        return (long long)((double)valueArray[0] * valueArray[1] / valueArray[2]);
+    }
+    return valueArray[0];
+}
+
+// 하드웨어 성능 카운터를 연다. 호출한 스레드(메인 스레드)만 측정하므로 디코딩, I/O 작업 스레드의 몫은 들어가지 않는다.
+// 파일 읽기의 페이지 폴트, 복사처럼 커널에서 쓰는 시간도 세도록 커널 영역을 포함해서 먼저 열어보고,
+// perf_event_paranoid가 허용하지 않으면 사용자 영역만 센다.
+// 커널 설정이나 가상 머신 때문에 열 수 없는 카운터는 건너뛰고 시간만 측정한다.
+void initProfiler()
+{
+    int openedCounterCount = 0;
+
+    for (int counterIndex = 0; counterIndex < PROFILE_COUNTER_COUNT; counterIndex++)
+    {
+        struct perf_event_attr attribute;
+        memset(&attribute, 0, sizeof(attribute));
+        attribute.size = sizeof(attribute);
+        attribute.type = profileCounterArray[counterIndex].type;
+        attribute.config = profileCounterArray[counterIndex].config;
+        attribute.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attribute.exclude_hv = 1;
+
+        attribute.exclude_kernel = 0;
+        fdProfileCounterArray[counterIndex] = syscall(__NR_perf_event_open, &attribute, 0, -1, -1, 0);
+        isKernelCountedArray[counterIndex] = fdProfileCounterArray[counterIndex] >= 0;
+        if (fdProfileCounterArray[counterIndex] < 0)
+        {
+            attribute.exclude_kernel = 1;
+            fdProfileCounterArray[counterIndex] = syscall(__NR_perf_event_open, &attribute, 0, -1, -1, 0);
+        }
+        if (fdProfileCounterArray[counterIndex] >= 0)
+        {
+            openedCounterCount++;
+        }
+    }
+
+    // 열지 못한 카운터를 알려준다.
+    if (openedCounterCount < PROFILE_COUNTER_COUNT)
+    {
+        printf("Profile : not available -");
+        for (int counterIndex = 0; counterIndex < PROFILE_COUNTER_COUNT; counterIndex++)
+        {
+            if (fdProfileCounterArray[counterIndex] < 0)
+            {
+                printf(" %s", profileCounterArray[counterIndex].pName);
+            }
+        }
+        printf("%s (check /proc/sys/kernel/perf_event_paranoid)\n", (openedCounterCount == 0) ? ", timing only." : "");
+    }
+    isProfilerEnabled = true;
+}
+
+// 측정을 시작한다. --profile을 지정하지 않았다면 아무것도 하지 않는다.
+void beginProfile(ProfileSample *pProfileSample)
+{
+    if (!isProfilerEnabled)
+    {
+        return;
+    }
+
+    for (int counterIndex = 0; counterIndex < PROFILE_COUNTER_COUNT; counterIndex++)
+    {
+        pProfileSample->counterArray[counterIndex] = (fdProfileCounterArray[counterIndex] >= 0)
+            ? readProfileCounter(fdProfileCounterArray[counterIndex])
+            : 0;
+    }
+    pProfileSample->startTime = getMonotonicTime();
+}
+
+// 측정을 끝내고 기능별 카운터 증가량과 메가픽셀당 값을 출력한다.
+void endProfile(
+    const ProfileSample *pProfileSample,
+    const char *pOperationName,
+    const long long pixelCount)
+{
+    if (!isProfilerEnabled)
+    {
+        return;
+    }
+
+    const long long elapsedTime = getMonotonicTime() - pProfileSample->startTime;
+    const double megaPixelCount = (double)pixelCount / 1000000;
+
+    long long counterDeltaArray[PROFILE_COUNTER_COUNT];
+    for (int counterIndex = 0; counterIndex < PROFILE_COUNTER_COUNT; counterIndex++)
+    {
+        counterDeltaArray[counterIndex] = (fdProfileCounterArray[counterIndex] >= 0)
+            ? readProfileCounter(fdProfileCounterArray[counterIndex]) - pProfileSample->counterArray[counterIndex]
+            : 0;
+    }
+
+    printf("PROFILE %s : %.3f ms, %.2f MP", pOperationName, (double)elapsedTime / 1000000, megaPixelCount);
+    if (megaPixelCount > 0)
+    {
+        printf(" (%.3f ms/MP)", (double)elapsedTime / 1000000 / megaPixelCount);
+    }
+    printf(", counters : main thread only\n");
+
+    for (int counterIndex = 0; counterIndex < PROFILE_COUNTER_COUNT; counterIndex++)
+    {
+        if (fdProfileCounterArray[counterIndex] < 0)
+        {
+            continue;
+        }
+
+        char counterName[PROFILE_COUNTER_NAME_LENGTH];
+        snprintf(counterName, sizeof(counterName), "%s%s", profileCounterArray[counterIndex].pName, isKernelCountedArray[counterIndex] ? "" : ":u");
+        printf("  %-14s %14lld", counterName, counterDeltaArray[counterIndex]);
+        if (megaPixelCount > 0)
+        {
+            printf("  %14.0f /MP", counterDeltaArray[counterIndex] / megaPixelCount);
+        }
+        printf("\n");
+    }
+
+    // 사이클당 명령어 수(IPC)가 낮으면 메모리 대기, 높으면 연산이 병목에 가깝다.
+    if (fdProfileCounterArray[PROFILE_COUNTER_CYCLES] >= 0 && fdProfileCounterArray[PROFILE_COUNTER_INSTRUCTIONS] >= 0
+        && counterDeltaArray[PROFILE_COUNTER_INSTRUCTIONS] > 0)
+    {
+        printf("  %-14s %14.2f\n", "IPC",
+            (double)counterDeltaArray[PROFILE_COUNTER_INSTRUCTIONS] / MAX(1, counterDeltaArray[PROFILE_COUNTER_CYCLES]));
+    }
+}
+
+// 열어둔 카운터를 닫는다.
+void closeProfiler()
+{
+    if (!isProfilerEnabled)
+    {
+        return;
+    }
+
+    for (int counterIndex = 0; counterIndex < PROFILE_COUNTER_COUNT; counterIndex++)
+    {
+        if (fdProfileCounterArray[counterIndex] >= 0)
+        {
+            close(fdProfileCounterArray[counterIndex]);
+        }
+    }
+    isProfilerEnabled = false;
+}
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <linux/fb.h>
+#include <string.h>
+#include <errno.h>
+
+#include "fbbmp.h"
+
+// 비동기 읽기가 채우고 출력 단계가 비우는 링 버퍼의 칸 하나. 파일의 연속된 행 여러 개를 담는다.
+typedef struct progressiveBand
+{
+    unsigned char *pBuffer;             // 파일에서 읽은 행 데이터 (패딩 포함)
+    int firstFileRow;                   // 첫 행의 파일 상 행 번호 (비트맵은 아래 행부터 저장된다.)
+    int rowCount;                       // 담긴 행 수
+    AsyncIORequest readRequest;         // 이 칸을 채우는 읽기 요청
+} ProgressiveBand;
+
+// 링 버퍼 전체의 상태
+typedef struct progressiveLoader
+{
+    int fdBitmapInput;                  // 이미지 파일 디스크립터
+    long long dataOffset;               // 파일에서 픽셀 데이터의 시작 위치
+    int fileRowBytes;                   // 파일에서 한 행의 바이트 크기 (패딩 포함)
+    int fileRowCount;                   // 전체 행 수
+    int bandRowCount;                   // 칸 하나에 담는 행 수
+    int bandCount;                      // 전체 행 묶음 수
+    ProgressiveBand bandArray[PROGRESSIVE_RING_SIZE];
+} ProgressiveLoader;
+
+// bandIndex번째 행 묶음을 읽는 요청을 해당 칸에 제출한다. 남은 행이 없으면 아무것도 하지 않는다.
+// 비트맵은 아래 행부터 저장되므로 파일의 끝에서부터 거꾸로 묶어서, 0번째 묶음이 이미지의 맨 위 행들이 되게 한다.
+static void submitBandRead(
+    ProgressiveLoader *pLoader,
+    const int bandIndex)
+{
+    if (bandIndex >= pLoader->bandCount)
+    {
+        return;
+    }
+
+    const int endFileRow = pLoader->fileRowCount - bandIndex * pLoader->bandRowCount;
+    const int firstFileRow = MAX(0, endFileRow - pLoader->bandRowCount);
+
+    ProgressiveBand *pBand = &pLoader->bandArray[bandIndex % PROGRESSIVE_RING_SIZE];
+    pBand->firstFileRow = firstFileRow;
+    pBand->rowCount = endFileRow - firstFileRow;
+
+    pBand->readRequest.operation = ASYNC_IO_READ;
+    pBand->readRequest.fd = pLoader->fdBitmapInput;
+    pBand->readRequest.pBuffer = pBand->pBuffer;
+    pBand->readRequest.length = pBand->rowCount * pLoader->fileRowBytes;
+    pBand->readRequest.offset = pLoader->dataOffset + (long long)firstFileRow * pLoader->fileRowBytes;
+    pBand->readRequest.pCompletionCallback = NULL;
+    submitAsyncIO(&pBand->readRequest);
+}
+
+// 이미지 행 [firstImageRow, lastImageRow]가 보이는 화면 행만 프레임 버퍼에 출력한다.
+static void drawImageRowsOnFrameBuffer(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    BMPHeader *pBitmapHeader,
+    RGBpixel **pBitmapPixel2dArray,
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport,
+    const int firstImageRow,
+    const int lastImageRow)
+{
+    // 화면 행 y는 이미지 행 originY + y * zoomOut / zoomIn 에 대응한다.
+    const int zoomIn = pViewport->zoomIn;
+    const int zoomOut = pViewport->zoomOut;
+    const int firstScreenRow = MAX(0, ((firstImageRow - pViewport->originY) * zoomIn + zoomOut - 1) / zoomOut);
+    const int lastScreenRow = MIN(getScreenHeight(fbvar) - 1, ((lastImageRow - pViewport->originY + 1) * zoomIn - 1) / zoomOut);
+
+    if (lastImageRow < pViewport->originY || firstScreenRow > lastScreenRow)
+    {
+        return;
+    }
+
+    drawImageRegionOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, pColorLUT, pViewport,
+        0, firstScreenRow, getScreenWidth(fbvar), lastScreenRow - firstScreenRow + 1);
+}
+
+// 비트맵 파일을 읽으면서 다 읽은 행 묶음부터 바로 프레임 버퍼에 출력한다.
+// 링 버퍼의 모든 칸에 읽기 요청을 미리 걸어두고, 한 칸을 비울 때마다 그 칸에 다음 읽기를 다시 건다.
+// 항상 여러 읽기가 진행중이므로 전체 시간은 읽기와 변환 시간의 합이 아니라 둘 중 긴 쪽에 가까워지고,
+// 파일의 뒤쪽부터 읽으므로 이미지의 맨 위 행이 곧바로 화면에 나타나고 아래로 채워진다.
+// pColorLUT가 NULL이면 출력하지 않고 읽기만 한다.
+// pColorHistogram이 NULL이 아니면 행을 옮기면서 캐시에 남아있는 행으로 채널별 히스토그램을 센다.
+void loadBitmapImageProgressive(
+    unsigned int *pfbmap,
+    const struct fb_var_screeninfo fbvar,
+    BMPHeader **pReturnBitmapHeader,
+    RGBpixel ***pReturnBitmapPixel2dArray,
+    const char *pFileName,
+    const ColorLUT *pColorLUT,
+    const Viewport *pViewport,
+    ColorHistogram *pColorHistogram)
+{
+    // 이미지 파일 열기
+    const int fdBitmapInput = open(pFileName, O_RDONLY);
+    if (fdBitmapInput < 0)
+    {
+        perror("Failed to open image file.");
+        exit(1);
+    }
+
+    // 비트맵 헤더 읽기. 파일이 헤더보다 짧으면 크기를 알 수 없으므로 실패로 처리한다.
+    BMPHeader bitmapHeader;
+    if (read(fdBitmapInput, &bitmapHeader, BITMAP_HEADER_SIZE) != BITMAP_HEADER_SIZE)
+    {
+        perror("Failed to read bitmap header.");
+        exit(1);
+    }
+
+    // 헤더, 행 포인터 배열, 모든 행을 버퍼 풀의 블록 하나에 연속으로 담는다. (가로 픽셀 수 * 픽셀 바이트 크기)
+    // 이미지를 바꿀 때 같은 크기의 블록을 다시 쓰므로 행마다 할당하지 않고 페이지 폴트도 거의 없다.
+    const int imageWidth = bitmapHeader.biWidth;
+    const int imageHeight = bitmapHeader.biHeight;
+    const size_t rowArrayOffset = (BITMAP_HEADER_SIZE + sizeof(RGBpixel *) - 1) / sizeof(RGBpixel *) * sizeof(RGBpixel *);
+    const size_t pixelOffset = rowArrayOffset + sizeof(RGBpixel *) * imageHeight;
+    unsigned char *pImageBuffer = (unsigned char *)allocatePoolBuffer(pixelOffset + sizeof(RGBpixel) * imageWidth * imageHeight);
+
+    BMPHeader *pBitmapHeader = (BMPHeader *)pImageBuffer;
+    memcpy(pBitmapHeader, &bitmapHeader, BITMAP_HEADER_SIZE);
+    RGBpixel **pBitmapPixel2dArray = (RGBpixel **)(pImageBuffer + rowArrayOffset);
+    for (int rowIndex = 0; rowIndex < imageHeight; rowIndex++)
+    {
+        pBitmapPixel2dArray[rowIndex] = (RGBpixel *)(pImageBuffer + pixelOffset) + (size_t)imageWidth * rowIndex;
+    }
+
+    // 링 버퍼 준비. 비트맵 너비가 4의 배수가 아닐 경우 행마다 패딩 바이트가 들어간다.
+    ProgressiveLoader loader = {0};
+    loader.fdBitmapInput = fdBitmapInput;
+    loader.dataOffset = pBitmapHeader->bfOffBits ? pBitmapHeader->bfOffBits : BITMAP_HEADER_SIZE;
+    loader.fileRowBytes = imageWidth * sizeof(RGBpixel) + imageWidth % 4;
+    loader.fileRowCount = imageHeight;
+    loader.bandRowCount = MAX(1, PROGRESSIVE_BAND_BYTES / loader.fileRowBytes);
+    loader.bandCount = (imageHeight + loader.bandRowCount - 1) / loader.bandRowCount;
+    for (int bandIndex = 0; bandIndex < PROGRESSIVE_RING_SIZE; bandIndex++)
+    {
+        loader.bandArray[bandIndex].pBuffer = (unsigned char *)allocatePoolBuffer(loader.fileRowBytes * loader.bandRowCount);
+    }
+
+    if (pColorHistogram)
+    {
+        memset(pColorHistogram, 0, sizeof(ColorHistogram));
+    }
+
+    // 모든 칸에 먼저 읽기를 걸어둔다.
+    for (int bandIndex = 0; bandIndex < PROGRESSIVE_RING_SIZE; bandIndex++)
+    {
+        submitBandRead(&loader, bandIndex);
+    }
+
+    // 출력 단계. 읽기가 끝난 칸을 순서대로 꺼내 이미지 행으로 옮기고 화면에 출력한다.
+    for (int bandIndex = 0; bandIndex < loader.bandCount; bandIndex++)
+    {
+        ProgressiveBand *pBand = &loader.bandArray[bandIndex % PROGRESSIVE_RING_SIZE];
+
+        // 파일이 중간에 끝나면 나머지는 검은색으로 채운다.
+        const int readBytes = waitAsyncIO(&pBand->readRequest);
+        if (readBytes < 0)
+        {
+            errno = -readBytes;
+            perror("Failed to read bitmap pixel.");
+            exit(1);
+        }
+        if (readBytes < pBand->readRequest.length)
+        {
+            memset(pBand->pBuffer + readBytes, 0, pBand->readRequest.length - readBytes);
+        }
+
+        // 비트맵 이미지는 위아래가 뒤집어져 있으므로 파일의 첫 행이 이미지의 마지막 행이다.
+        const int firstFileRow = pBand->firstFileRow;
+        const int rowCount = pBand->rowCount;
+        for (int bandRow = 0; bandRow < rowCount; bandRow++)
+        {
+            RGBpixel *pImageRow = pBitmapPixel2dArray[imageHeight - 1 - (firstFileRow + bandRow)];
+            memcpy(pImageRow, pBand->pBuffer + loader.fileRowBytes * bandRow, sizeof(RGBpixel) * imageWidth);
+
+            if (pColorHistogram)
+            {
+                accumulateColorHistogram(pColorHistogram, pImageRow, imageWidth);
+            }
+        }
+
+        // 비운 칸에 다음 읽기를 걸고, 그 읽기가 진행되는 동안 방금 옮긴 행을 변환해서 출력한다.
+        submitBandRead(&loader, bandIndex + PROGRESSIVE_RING_SIZE);
+
+        if (pColorLUT)
+        {
+            drawImageRowsOnFrameBuffer(pfbmap, fbvar, pBitmapHeader, pBitmapPixel2dArray, pColorLUT, pViewport,
+                imageHeight - firstFileRow - rowCount, imageHeight - 1 - firstFileRow);
+        }
+    }
+
+    for (int bandIndex = 0; bandIndex < PROGRESSIVE_RING_SIZE; bandIndex++)
+    {
+        releasePoolBuffer(loader.bandArray[bandIndex].pBuffer);
+    }
+
+    // 동적 할당한 주소를 넘겨준다.
+    *pReturnBitmapHeader = pBitmapHeader;
+    *pReturnBitmapPixel2dArray = pBitmapPixel2dArray;
+
+    close(fdBitmapInput);
+}
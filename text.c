@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <linux/fb.h>
+
+#include "fbbmp.h"
+
+// 내장 글꼴 (5x7, ASCII 32~126). 행마다 하위 5비트를 사용하고 0x10이 왼쪽 픽셀이다.
+static const unsigned char fontGlyphArray[FONT_LAST_CHARACTER - FONT_FIRST_CHARACTER + 1][FONT_GLYPH_HEIGHT] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},   // ' '
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04},   // '!'
+    {0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00},   // '"'
+    {0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A},   // '#'
+    {0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04},   // '$'
+    {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03},   // '%'
+    {0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D},   // '&'
+    {0x0C, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00},   // '\''
+    {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02},   // '('
+    {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08},   // ')'
+    {0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00},   // '*'
+    {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00},   // '+'
+    {0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08},   // ','
+    {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00},   // '-'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C},   // '.'
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00},   // '/'
+    {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E},   // '0'
+    {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E},   // '1'
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F},   // '2'
+    {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E},   // '3'
+    {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02},   // '4'
+    {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E},   // '5'
+    {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E},   // '6'
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},   // '7'
+    {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E},   // '8'
+    {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C},   // '9'
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00},   // ':'
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08},   // ';'
+    {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02},   // '<'
+    {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00},   // '='
+    {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08},   // '>'
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04},   // '?'
+    {0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E},   // '@'
+    {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11},   // 'A'
+    {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E},   // 'B'
+    {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E},   // 'C'
+    {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C},   // 'D'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F},   // 'E'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10},   // 'F'
+    {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F},   // 'G'
+    {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11},   // 'H'
+    {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E},   // 'I'
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C},   // 'J'
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11},   // 'K'
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F},   // 'L'
+    {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11},   // 'M'
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},   // 'N'
+    {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E},   // 'O'
+    {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10},   // 'P'
+    {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D},   // 'Q'
+    {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11},   // 'R'
+    {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E},   // 'S'
+    {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},   // 'T'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E},   // 'U'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04},   // 'V'
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A},   // 'W'
+    {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11},   // 'X'
+    {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04},   // 'Y'
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F},   // 'Z'
+    {0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E},   // '['
+    {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00},   // '\\'
+    {0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E},   // ']'
+    {0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00},   // '^'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F},   // '_'
+    {0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00},   // '`'
+    {0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F},   // 'a'
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E},   // 'b'
+    {0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E},   // 'c'
+    {0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F},   // 'd'
+    {0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E},   // 'e'
+    {0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08},   // 'f'
+    {0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x0E},   // 'g'
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11},   // 'h'
+    {0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E},   // 'i'
+    {0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0C},   // 'j'
+    {0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12},   // 'k'
+    {0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E},   // 'l'
+    {0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11},   // 'm'
+    {0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11},   // 'n'
+    {0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E},   // 'o'
+    {0x00, 0x00, 0x1E, 0x11, 0x1E, 0x10, 0x10},   // 'p'
+    {0x00, 0x00, 0x0D, 0x13, 0x0F, 0x01, 0x01},   // 'q'
+    {0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10},   // 'r'
+    {0x00, 0x00, 0x0E, 0x10, 0x0E, 0x01, 0x1E},   // 's'
+    {0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06},   // 't'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D},   // 'u'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04},   // 'v'
+    {0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A},   // 'w'
+    {0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11},   // 'x'
+    {0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x0E},   // 'y'
+    {0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F},   // 'z'
+    {0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02},   // '{'
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},   // '|'
+    {0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08},   // '}'
+    {0x00, 0x00, 0x00, 0x0D, 0x12, 0x00, 0x00},   // '~'
+};
+
+// 글자 레이어 목록과 글자 모양 캐시
+static TextOverlay textOverlayArray[TEXT_OVERLAY_MAX];
+static int textOverlayCount = 0;
+static unsigned int *pGlyphCache = NULL;    // 글자마다 확대한 한 칸을 레이어 픽셀 형식으로 펼쳐둔 배열
+static unsigned int glyphBackgroundPixel;   // 글자 뒤 배경 픽셀
+
+// 확대한 글자 한 칸의 크기
+static const int glyphCellWidth = TEXT_CELL_WIDTH * TEXT_OVERLAY_SCALE;
+static const int glyphCellHeight = TEXT_CELL_HEIGHT * TEXT_OVERLAY_SCALE;
+
+// 모든 글자를 확대해서 레이어 픽셀 형식(프레임 버퍼 형식 색상 + 알파)으로 한 번만 펼쳐둔다.
+// 글자를 그릴 때는 캐시의 행을 레이어로 복사하기만 하면 된다.
+static void buildGlyphCache()
+{
+    const int glyphCount = FONT_LAST_CHARACTER - FONT_FIRST_CHARACTER + 1;
+    const RGBpixel foregroundColor = {UCHAR_MAX, UCHAR_MAX, UCHAR_MAX};
+    const RGBpixel backgroundColor = {0, 0, 0};
+    const unsigned int foregroundPixel = convertToOverlayPixel(foregroundColor, UCHAR_MAX);
+    glyphBackgroundPixel = convertToOverlayPixel(backgroundColor, TEXT_OVERLAY_BACKGROUND_ALPHA);
+
+    pGlyphCache = (unsigned int *)malloc(sizeof(unsigned int) * glyphCount * glyphCellWidth * glyphCellHeight);
+    if (!pGlyphCache)
+    {
+        perror("Failed to allocate glyph cache.");
+        exit(1);
+    }
+
+    for (int glyphIndex = 0; glyphIndex < glyphCount; glyphIndex++)
+    {
+        unsigned int *pGlyph = pGlyphCache + glyphIndex * glyphCellWidth * glyphCellHeight;
+        for (int rowIndex = 0; rowIndex < glyphCellHeight; rowIndex++)
+        {
+            // 칸의 왼쪽 1열과 위아래 1행은 여백이다.
+            const int fontRow = rowIndex / TEXT_OVERLAY_SCALE - 1;
+            for (int columnIndex = 0; columnIndex < glyphCellWidth; columnIndex++)
+            {
+                const int fontColumn = columnIndex / TEXT_OVERLAY_SCALE - 1;
+                const bool isForeground = fontRow >= 0 && fontRow < FONT_GLYPH_HEIGHT && fontColumn >= 0
+                    && (fontGlyphArray[glyphIndex][fontRow] >> (FONT_GLYPH_WIDTH - 1 - fontColumn)) & 1;
+                pGlyph[glyphCellWidth * rowIndex + columnIndex] = isForeground ? foregroundPixel : glyphBackgroundPixel;
+            }
+        }
+    }
+}
+
+// 한 줄짜리 글자 레이어를 만든다. x, y가 음수이면 화면 오른쪽, 아래쪽 끝에서부터의 거리이다.
+// 레이어 오른쪽에는 마지막 글자 뒤 여백 1열이 붙는다. 글자가 없는 부분은 투명하다.
+int addTextOverlay(
+    const struct fb_var_screeninfo fbvar,
+    const int columnCount,
+    const int x,
+    const int y)
+{
+    if (textOverlayCount >= TEXT_OVERLAY_MAX || columnCount <= 0 || columnCount > TEXT_OVERLAY_MAX_COLUMN)
+    {
+        printf("Invalid text overlay - max %d layers, %d columns\n", TEXT_OVERLAY_MAX, TEXT_OVERLAY_MAX_COLUMN);
+        exit(1);
+    }
+
+    // 글자 모양은 프레임 버퍼 BPP에 따라 달라지므로 처음 사용할 때 펼친다.
+    if (!pGlyphCache)
+    {
+        buildGlyphCache();
+    }
+
+    TextOverlay *pTextOverlay = &textOverlayArray[textOverlayCount];
+    pTextOverlay->layerIndex = createOverlayLayer(fbvar, glyphCellWidth * columnCount + TEXT_OVERLAY_SCALE, glyphCellHeight, x, y);
+    pTextOverlay->columnCount = columnCount;
+    pTextOverlay->text[0] = '\0';
+    return textOverlayCount++;
+}
+
+// 글자 레이어의 내용을 바꾼다. 글자 수를 넘는 부분은 잘리고, 글꼴에 없는 문자는 '?'로 그린다.
+// 내용이 같으면 아무것도 하지 않고, 바뀌었다면 글자 칸의 행을 캐시에서 복사한 뒤 레이어 영역만 다시 그리도록 표시한다.
+void setTextOverlay(
+    const int textIndex,
+    const char *pText)
+{
+    TextOverlay *pTextOverlay = &textOverlayArray[textIndex];
+    const int textLength = MIN((int)strlen(pText), pTextOverlay->columnCount);
+    if ((int)strlen(pTextOverlay->text) == textLength && !strncmp(pTextOverlay->text, pText, textLength))
+    {
+        return;
+    }
+    memcpy(pTextOverlay->text, pText, textLength);
+    pTextOverlay->text[textLength] = '\0';
+
+    unsigned int *pLayerPixelArray = getOverlayLayerPixelArray(pTextOverlay->layerIndex);
+    const int layerWidth = glyphCellWidth * pTextOverlay->columnCount + TEXT_OVERLAY_SCALE;
+    const int textWidth = glyphCellWidth * textLength;
+
+    for (int rowIndex = 0; rowIndex < glyphCellHeight; rowIndex++)
+    {
+        unsigned int *pLayerRow = pLayerPixelArray + layerWidth * rowIndex;
+        for (int characterIndex = 0; characterIndex < textLength; characterIndex++)
+        {
+            char character = pText[characterIndex];
+            if (character < FONT_FIRST_CHARACTER || character > FONT_LAST_CHARACTER)
+            {
+                character = '?';
+            }
+
+            const unsigned int *pGlyphRow = pGlyphCache
+                + ((character - FONT_FIRST_CHARACTER) * glyphCellHeight + rowIndex) * glyphCellWidth;
+            memcpy(pLayerRow + glyphCellWidth * characterIndex, pGlyphRow, sizeof(unsigned int) * glyphCellWidth);
+        }
+
+        // 마지막 글자 뒤 여백, 나머지는 투명
+        for (int columnIndex = textWidth; columnIndex < layerWidth; columnIndex++)
+        {
+            pLayerRow[columnIndex] = (textLength && columnIndex < textWidth + TEXT_OVERLAY_SCALE) ? glyphBackgroundPixel : 0;
+        }
+    }
+
+    markOverlayLayerDirty(pTextOverlay->layerIndex);
+}
+
+// 글자 레이어에 현재 시각(HH:MM:SS)을 쓴다. 초가 바뀌어 레이어를 다시 그려야 하면 true를 반환한다.
+// 1초에 한 번 바뀌므로 매번 글자 레이어 영역(수 KB)만 다시 그려진다.
+bool updateClockOverlay(const int textIndex)
+{
+    const time_t currentTime = time(NULL);
+    struct tm localTime;
+    localtime_r(&currentTime, &localTime);
+
+    char clockText[CLOCK_TEXT_COLUMN_COUNT + 1];
+    strftime(clockText, sizeof(clockText), "%H:%M:%S", &localTime);
+    if (!strcmp(textOverlayArray[textIndex].text, clockText))
+    {
+        return false;
+    }
+
+    setTextOverlay(textIndex, clockText);
+    return true;
+}
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <linux/fb.h>
+
+#include "fbbmp.h"
+
+// 입력 기록, 재생의 공유 상태
+static int inputTraceMode = INPUT_TRACE_NONE;   // 기록, 재생 여부
+static bool isReplayMaxSpeed = false;           // 재생 시 기록된 간격을 무시하고 바로 다음 입력을 넣는다.
+static FILE *pInputTraceFile = NULL;            // 기록 파일
+static long long traceStartTime = 0;            // 기록, 재생을 시작한 시각 (나노초)
+static long long eventStartTime = -1;           // 처리 중인 재생 입력이 들어온 시각 (나노초, 없으면 -1)
+static int eventCommand = 0;                    // 처리 중인 재생 입력
+static int replayedEventCount = 0;              // 처리를 마친 재생 입력 수
+static long long totalEventLatency = 0;         // 재생 입력의 처리 시간 합 (나노초)
+static long long maxEventLatency = 0;           // 재생 입력의 최대 처리 시간 (나노초)
+
+// 입력 기록 또는 재생을 시작한다. INPUT_TRACE_NONE이면 아무것도 하지 않는다.
+void initInputTrace(
+    const int mode,
+    const char *pFileName,
+    const bool isMaxSpeed)
+{
+    inputTraceMode = mode;
+    isReplayMaxSpeed = isMaxSpeed;
+    if (mode == INPUT_TRACE_NONE)
+    {
+        return;
+    }
+
+    pInputTraceFile = fopen(pFileName, (mode == INPUT_TRACE_RECORD) ? "w" : "r");
+    if (!pInputTraceFile)
+    {
+        perror("Failed to open input trace file.");
+        exit(1);
+    }
+
+    if (mode == INPUT_TRACE_RECORD)
+    {
+        fprintf(pInputTraceFile, "# fbbmp input trace : <microseconds since start> <command>\n");
+    }
+    traceStartTime = getMonotonicTime();
+}
+
+// 입력 하나를 시각과 함께 기록한다. 기록 중이 아니면 아무것도 하지 않는다.
+// 비정상 종료되어도 그때까지의 입력이 남도록 매번 파일에 내보낸다.
+void recordInputEvent(const int command)
+{
+    if (inputTraceMode != INPUT_TRACE_RECORD || command == 0)
+    {
+        return;
+    }
+
+    fprintf(pInputTraceFile, "%lld %d\n", (getMonotonicTime() - traceStartTime) / 1000, command);
+    fflush(pInputTraceFile);
+}
+
+// 재생 중인지 확인한다.
+bool isInputReplaying()
+{
+    return inputTraceMode == INPUT_TRACE_REPLAY;
+}
+
+// 기록 파일에서 다음 입력을 읽는다. 기록된 속도로 재생한다면 기록된 시각까지 기다린다.
+// 기록이 끝나면 -1을 반환한다.
+int readReplayEvent()
+{
+    char lineBuffer[FILE_NAME_MAX_LENGTH];
+    long long eventTime = 0;
+    int command = 0;
+
+    // 주석과 빈 줄은 건너뛴다.
+    do
+    {
+        if (!fgets(lineBuffer, sizeof(lineBuffer), pInputTraceFile))
+        {
+            return -1;
+        }
+    } while (sscanf(lineBuffer, "%lld %d", &eventTime, &command) != 2);
+
+    // 처리 시간은 입력이 들어와야 했던 시각부터 잰다. 앞선 입력 처리가 늦어져 밀린 시간도 사용자가 느끼는 지연이다.
+    if (isReplayMaxSpeed)
+    {
+        eventStartTime = getMonotonicTime();
+    }
+    else
+    {
+        const long long scheduledTime = traceStartTime + eventTime * 1000;
+        const struct timespec wakeTime = {scheduledTime / 1000000000LL, scheduledTime % 1000000000LL};
+        // clock_nanosleep은 errno를 쓰지 않고 오류 번호를 반환한다. 시그널로 깬 경우(EINTR)에만 다시 잔다.
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, NULL) == EINTR)
+        {
+        }
+        eventStartTime = scheduledTime;
+    }
+
+    eventCommand = command;
+    return command;
+}
+
+// 직전 재생 입력의 처리가 끝났음을 알리고 처리 시간을 출력한다. 처리 중인 입력이 없으면 아무것도 하지 않는다.
+void finishReplayEvent()
+{
+    if (inputTraceMode != INPUT_TRACE_REPLAY || eventStartTime < 0)
+    {
+        return;
+    }
+
+    const long long latency = getMonotonicTime() - eventStartTime;
+    totalEventLatency += latency;
+    maxEventLatency = MAX(maxEventLatency, latency);
+    replayedEventCount++;
+    eventStartTime = -1;
+
+    printf("REPLAY #%d command %d : %.3f ms\n", replayedEventCount, eventCommand, (double)latency / 1000000);
+}
+
+// 기록 파일을 닫는다. 재생이었다면 처리 시간 요약을 출력한다.
+void closeInputTrace()
+{
+    if (inputTraceMode == INPUT_TRACE_NONE)
+    {
+        return;
+    }
+
+    finishReplayEvent();
+    if (inputTraceMode == INPUT_TRACE_REPLAY)
+    {
+        printf("REPLAY : %d events, total %.3f ms, average %.3f ms, max %.3f ms\n",
+            replayedEventCount,
+            (double)(getMonotonicTime() - traceStartTime) / 1000000,
+            replayedEventCount ? (double)totalEventLatency / replayedEventCount / 1000000 : 0.0,
+            (double)maxEventLatency / 1000000);
+    }
+
+    fclose(pInputTraceFile);
+    pInputTraceFile = NULL;
+    inputTraceMode = INPUT_TRACE_NONE;
+}